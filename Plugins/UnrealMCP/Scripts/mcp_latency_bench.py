@@ -0,0 +1,215 @@
+"""Measures MCP request latency with several concurrent clients.
+
+Against a running editor:
+    python mcp_latency_bench.py --clients 1 4 16
+
+Each client opens its own connection and sends --requests commands one after another,
+waiting for each response. The p50/p99 of all round trips are printed per client count.
+MCP.LogLatency in the editor console shows the server side view of the same run.
+
+--model old|new starts a local stand-in server instead of connecting to the editor. It
+reproduces the accept and receive loop of FMCPServerRunnable before and after concurrent
+client connections, with commands handed to a simulated game thread ticking at --fps.
+That isolates the socket loop from editor load and is what the numbers in the history
+were taken with.
+"""
+
+import argparse
+import queue
+import select
+import socket
+import statistics
+import threading
+import time
+
+DEFAULT_HOST = "127.0.0.1"
+DEFAULT_PORT = 55557
+
+
+class JsonFrameReader:
+    """Splits a byte stream into top level JSON objects, the framing the MCP server detects for '{'."""
+
+    def __init__(self, sock):
+        self.sock = sock
+        self.buffer = b""
+
+    def read_frame(self):
+        depth = 0
+        in_string = False
+        escaped = False
+        start = None
+        offset = 0
+        while True:
+            while offset < len(self.buffer):
+                char = self.buffer[offset:offset + 1]
+                if in_string:
+                    if escaped:
+                        escaped = False
+                    elif char == b"\\":
+                        escaped = True
+                    elif char == b'"':
+                        in_string = False
+                elif char == b'"':
+                    in_string = True
+                elif char == b"{":
+                    if depth == 0:
+                        start = offset
+                    depth += 1
+                elif char == b"}":
+                    depth -= 1
+                    if depth == 0 and start is not None:
+                        frame = self.buffer[start:offset + 1]
+                        self.buffer = self.buffer[offset + 1:]
+                        return frame
+                offset += 1
+
+            data = self.sock.recv(65536)
+            if not data:
+                raise ConnectionError("server closed the connection")
+            self.buffer += data
+
+
+def run_client(host, port, command, num_requests, start_barrier, latencies, lock):
+    with socket.create_connection((host, port)) as sock:
+        sock.setsockopt(socket.IPPROTO_TCP, socket.TCP_NODELAY, 1)
+        reader = JsonFrameReader(sock)
+        request = ('{"type": "%s", "params": {}}' % command).encode()
+
+        start_barrier.wait()
+
+        samples = []
+        for _ in range(num_requests):
+            start = time.perf_counter()
+            sock.sendall(request)
+            reader.read_frame()
+            samples.append(time.perf_counter() - start)
+
+    with lock:
+        latencies.extend(samples)
+
+
+def run_bench(host, port, command, num_clients, num_requests):
+    latencies = []
+    lock = threading.Lock()
+    start_barrier = threading.Barrier(num_clients)
+
+    threads = [threading.Thread(target=run_client,
+                                args=(host, port, command, num_requests, start_barrier, latencies, lock))
+               for _ in range(num_clients)]
+    for thread in threads:
+        thread.start()
+    for thread in threads:
+        thread.join()
+
+    latencies.sort()
+    p50 = statistics.median(latencies)
+    p99 = latencies[min(len(latencies) - 1, int(len(latencies) * 0.99))]
+    return p50 * 1000.0, p99 * 1000.0
+
+
+class ModelGameThread:
+    """Runs queued commands once per frame, like AsyncTask(ENamedThreads::GameThread) does in the editor."""
+
+    def __init__(self, fps, command_cost):
+        self.frame_time = 1.0 / fps
+        self.command_cost = command_cost
+        self.tasks = queue.Queue()
+        self.running = True
+        self.thread = threading.Thread(target=self.run, daemon=True)
+        self.thread.start()
+
+    def run(self):
+        while self.running:
+            frame_start = time.perf_counter()
+            while True:
+                try:
+                    done = self.tasks.get_nowait()
+                except queue.Empty:
+                    break
+                time.sleep(self.command_cost)
+                done.set()
+            time.sleep(max(0.0, self.frame_time - (time.perf_counter() - frame_start)))
+
+    def execute(self):
+        done = threading.Event()
+        self.tasks.put(done)
+        done.wait()
+        return b'{"status": "success", "result": {"message": "pong"}}'
+
+
+def serve_model_old(listener, game_thread, stop):
+    """One client at a time, the next is only accepted once the current one disconnects."""
+    while not stop.is_set():
+        readable, _, _ = select.select([listener], [], [], 0)
+        if readable:
+            client, _ = listener.accept()
+            client.setsockopt(socket.IPPROTO_TCP, socket.TCP_NODELAY, 1)
+            with client:
+                while not stop.is_set():
+                    # Each Recv is parsed as exactly one message
+                    data = client.recv(8192)
+                    if not data:
+                        break
+                    client.sendall(game_thread.execute())
+        time.sleep(0.1)
+
+
+def serve_model_new(listener, game_thread, stop):
+    """Thread per client, every thread blocks on socket readiness."""
+
+    def serve_client(client):
+        client.setsockopt(socket.IPPROTO_TCP, socket.TCP_NODELAY, 1)
+        reader = JsonFrameReader(client)
+        with client:
+            while not stop.is_set():
+                readable, _, _ = select.select([client], [], [], 0.1)
+                if not readable:
+                    continue
+                try:
+                    reader.read_frame()
+                except ConnectionError:
+                    break
+                client.sendall(game_thread.execute())
+
+    while not stop.is_set():
+        readable, _, _ = select.select([listener], [], [], 0.1)
+        if readable:
+            client, _ = listener.accept()
+            threading.Thread(target=serve_client, args=(client,), daemon=True).start()
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("--host", default=DEFAULT_HOST)
+    parser.add_argument("--port", type=int, default=DEFAULT_PORT)
+    parser.add_argument("--clients", type=int, nargs="+", default=[1, 4, 16])
+    parser.add_argument("--requests", type=int, default=50, help="requests per client")
+    parser.add_argument("--command", default="ping")
+    parser.add_argument("--model", choices=["old", "new"], help="benchmark a local stand-in server")
+    parser.add_argument("--fps", type=float, default=60.0, help="game thread rate of the stand-in server")
+    parser.add_argument("--command-cost-ms", type=float, default=0.5, help="game thread time per command of the stand-in server")
+    args = parser.parse_args()
+
+    stop = threading.Event()
+    host, port = args.host, args.port
+    if args.model:
+        listener = socket.socket(socket.AF_INET, socket.SOCK_STREAM)
+        listener.setsockopt(socket.SOL_SOCKET, socket.SO_REUSEADDR, 1)
+        listener.bind((DEFAULT_HOST, 0))
+        listener.listen(64)
+        host, port = listener.getsockname()
+
+        game_thread = ModelGameThread(args.fps, args.command_cost_ms / 1000.0)
+        serve = serve_model_old if args.model == "old" else serve_model_new
+        threading.Thread(target=serve, args=(listener, game_thread, stop), daemon=True).start()
+
+    label = "model-%s" % args.model if args.model else "%s:%d" % (host, port)
+    for num_clients in args.clients:
+        p50, p99 = run_bench(host, port, args.command, num_clients, args.requests)
+        print("%s clients=%2d requests=%d p50=%8.2f ms p99=%8.2f ms" % (label, num_clients, args.requests, p50, p99))
+
+    stop.set()
+
+
+if __name__ == "__main__":
+    main()
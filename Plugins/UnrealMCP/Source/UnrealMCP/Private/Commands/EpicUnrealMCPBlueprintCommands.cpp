@@ -1,5 +1,7 @@
 #include "Commands/EpicUnrealMCPBlueprintCommands.h"
 #include "Commands/EpicUnrealMCPCommonUtils.h"
+#include "Commands/EpicUnrealMCPCommandRegistry.h"
+#include "MCPEditorSnapshot.h"
 #include "Engine/Blueprint.h"
 #include "Engine/BlueprintGeneratedClass.h"
 #include "Factories/BlueprintFactory.h"
@@ -33,76 +35,48 @@ FEpicUnrealMCPBlueprintCommands::FEpicUnrealMCPBlueprintCommands()
 {
 }
 
-TSharedPtr<FJsonObject> FEpicUnrealMCPBlueprintCommands::HandleCommand(const FString& CommandType, const TSharedPtr<FJsonObject>& Params)
+void FEpicUnrealMCPBlueprintCommands::RegisterCommands(FEpicUnrealMCPCommandRegistry& Registry)
 {
-    if (CommandType == TEXT("create_blueprint"))
-    {
-        return HandleCreateBlueprint(Params);
-    }
-    else if (CommandType == TEXT("add_component_to_blueprint"))
-    {
-        return HandleAddComponentToBlueprint(Params);
-    }
-    else if (CommandType == TEXT("set_physics_properties"))
-    {
-        return HandleSetPhysicsProperties(Params);
-    }
-    else if (CommandType == TEXT("compile_blueprint"))
-    {
-        return HandleCompileBlueprint(Params);
-    }
-    else if (CommandType == TEXT("set_static_mesh_properties"))
-    {
-        return HandleSetStaticMeshProperties(Params);
-    }
-    else if (CommandType == TEXT("spawn_blueprint_actor"))
-    {
-        return HandleSpawnBlueprintActor(Params);
-    }
-    else if (CommandType == TEXT("set_mesh_material_color"))
-    {
-        return HandleSetMeshMaterialColor(Params);
-    }
+    const FString Category = TEXT("blueprint");
+    const EMCPCommandFlags ReadFlags = EMCPCommandFlags::GameThread | EMCPCommandFlags::ReadOnly | EMCPCommandFlags::Batchable;
+    const EMCPCommandFlags WriteFlags = EMCPCommandFlags::GameThread | EMCPCommandFlags::Batchable;
+
+    Registry.Register(TEXT("create_blueprint"), Category, WriteFlags,
+        FMCPCommandHandler::CreateRaw(this, &FEpicUnrealMCPBlueprintCommands::HandleCreateBlueprint));
+    Registry.Register(TEXT("add_component_to_blueprint"), Category, WriteFlags,
+        FMCPCommandHandler::CreateRaw(this, &FEpicUnrealMCPBlueprintCommands::HandleAddComponentToBlueprint));
+    Registry.Register(TEXT("set_physics_properties"), Category, WriteFlags,
+        FMCPCommandHandler::CreateRaw(this, &FEpicUnrealMCPBlueprintCommands::HandleSetPhysicsProperties));
+    Registry.Register(TEXT("compile_blueprint"), Category, WriteFlags,
+        FMCPCommandHandler::CreateRaw(this, &FEpicUnrealMCPBlueprintCommands::HandleCompileBlueprint));
+    Registry.Register(TEXT("set_static_mesh_properties"), Category, WriteFlags,
+        FMCPCommandHandler::CreateRaw(this, &FEpicUnrealMCPBlueprintCommands::HandleSetStaticMeshProperties));
+    Registry.Register(TEXT("spawn_blueprint_actor"), Category, WriteFlags,
+        FMCPCommandHandler::CreateRaw(this, &FEpicUnrealMCPBlueprintCommands::HandleSpawnBlueprintActor));
+    Registry.Register(TEXT("set_mesh_material_color"), Category, WriteFlags,
+        FMCPCommandHandler::CreateRaw(this, &FEpicUnrealMCPBlueprintCommands::HandleSetMeshMaterialColor));
+
     // Material management commands
-    else if (CommandType == TEXT("get_available_materials"))
-    {
-        return HandleGetAvailableMaterials(Params);
-    }
-    else if (CommandType == TEXT("apply_material_to_actor"))
-    {
-        return HandleApplyMaterialToActor(Params);
-    }
-    else if (CommandType == TEXT("apply_material_to_blueprint"))
-    {
-        return HandleApplyMaterialToBlueprint(Params);
-    }
-    else if (CommandType == TEXT("get_actor_material_info"))
-    {
-        return HandleGetActorMaterialInfo(Params);
-    }
-    else if (CommandType == TEXT("get_blueprint_material_info"))
-    {
-        return HandleGetBlueprintMaterialInfo(Params);
-    }
-    // Blueprint analysis commands
-    else if (CommandType == TEXT("read_blueprint_content"))
-    {
-        return HandleReadBlueprintContent(Params);
-    }
-    else if (CommandType == TEXT("analyze_blueprint_graph"))
-    {
-        return HandleAnalyzeBlueprintGraph(Params);
-    }
-    else if (CommandType == TEXT("get_blueprint_variable_details"))
-    {
-        return HandleGetBlueprintVariableDetails(Params);
-    }
-    else if (CommandType == TEXT("get_blueprint_function_details"))
-    {
-        return HandleGetBlueprintFunctionDetails(Params);
-    }
+    Registry.Register(TEXT("get_available_materials"), Category, ReadFlags,
+        FMCPCommandHandler::CreateRaw(this, &FEpicUnrealMCPBlueprintCommands::HandleGetAvailableMaterials));
+    Registry.Register(TEXT("apply_material_to_actor"), Category, WriteFlags,
+        FMCPCommandHandler::CreateRaw(this, &FEpicUnrealMCPBlueprintCommands::HandleApplyMaterialToActor));
+    Registry.Register(TEXT("apply_material_to_blueprint"), Category, WriteFlags,
+        FMCPCommandHandler::CreateRaw(this, &FEpicUnrealMCPBlueprintCommands::HandleApplyMaterialToBlueprint));
+    Registry.Register(TEXT("get_actor_material_info"), Category, ReadFlags,
+        FMCPCommandHandler::CreateRaw(this, &FEpicUnrealMCPBlueprintCommands::HandleGetActorMaterialInfo));
+    Registry.Register(TEXT("get_blueprint_material_info"), Category, ReadFlags,
+        FMCPCommandHandler::CreateRaw(this, &FEpicUnrealMCPBlueprintCommands::HandleGetBlueprintMaterialInfo));
 
-    return FEpicUnrealMCPCommonUtils::CreateErrorResponse(FString::Printf(TEXT("Unknown blueprint command: %s"), *CommandType));
+    // Blueprint analysis commands
+    Registry.Register(TEXT("read_blueprint_content"), Category, ReadFlags,
+        FMCPCommandHandler::CreateRaw(this, &FEpicUnrealMCPBlueprintCommands::HandleReadBlueprintContent));
+    Registry.Register(TEXT("analyze_blueprint_graph"), Category, ReadFlags,
+        FMCPCommandHandler::CreateRaw(this, &FEpicUnrealMCPBlueprintCommands::HandleAnalyzeBlueprintGraph));
+    Registry.Register(TEXT("get_blueprint_variable_details"), Category, ReadFlags,
+        FMCPCommandHandler::CreateRaw(this, &FEpicUnrealMCPBlueprintCommands::HandleGetBlueprintVariableDetails));
+    Registry.Register(TEXT("get_blueprint_function_details"), Category, ReadFlags,
+        FMCPCommandHandler::CreateRaw(this, &FEpicUnrealMCPBlueprintCommands::HandleGetBlueprintFunctionDetails));
 }
 
 TSharedPtr<FJsonObject> FEpicUnrealMCPBlueprintCommands::HandleCreateBlueprint(const TSharedPtr<FJsonObject>& Params)
@@ -1358,70 +1332,7 @@ TSharedPtr<FJsonObject> FEpicUnrealMCPBlueprintCommands::HandleAnalyzeBlueprintG
         return FEpicUnrealMCPCommonUtils::CreateErrorResponse(FString::Printf(TEXT("Graph not found: %s"), *GraphName));
     }
 
-    TSharedPtr<FJsonObject> GraphData = MakeShared<FJsonObject>();
-    GraphData->SetStringField(TEXT("graph_name"), TargetGraph->GetName());
-    GraphData->SetStringField(TEXT("graph_type"), TargetGraph->GetClass()->GetName());
-
-    // Analyze nodes
-    TArray<TSharedPtr<FJsonValue>> NodeArray;
-    TArray<TSharedPtr<FJsonValue>> ConnectionArray;
-
-    for (UEdGraphNode* Node : TargetGraph->Nodes)
-    {
-        if (Node)
-        {
-            TSharedPtr<FJsonObject> NodeObj = MakeShared<FJsonObject>();
-            NodeObj->SetStringField(TEXT("name"), Node->GetName());
-            NodeObj->SetStringField(TEXT("class"), Node->GetClass()->GetName());
-            NodeObj->SetStringField(TEXT("title"), Node->GetNodeTitle(ENodeTitleType::FullTitle).ToString());
-
-            if (bIncludeNodeDetails)
-            {
-                NodeObj->SetNumberField(TEXT("pos_x"), Node->NodePosX);
-                NodeObj->SetNumberField(TEXT("pos_y"), Node->NodePosY);
-                NodeObj->SetBoolField(TEXT("can_rename"), Node->bCanRenameNode);
-            }
-
-            // Include pin information if requested
-            if (bIncludePinConnections)
-            {
-                TArray<TSharedPtr<FJsonValue>> PinArray;
-                for (UEdGraphPin* Pin : Node->Pins)
-                {
-                    if (Pin)
-                    {
-                        TSharedPtr<FJsonObject> PinObj = MakeShared<FJsonObject>();
-                        PinObj->SetStringField(TEXT("name"), Pin->PinName.ToString());
-                        PinObj->SetStringField(TEXT("type"), Pin->PinType.PinCategory.ToString());
-                        PinObj->SetStringField(TEXT("direction"), Pin->Direction == EGPD_Input ? TEXT("Input") : TEXT("Output"));
-                        PinObj->SetNumberField(TEXT("connections"), Pin->LinkedTo.Num());
-                        
-                        // Record connections for this pin
-                        for (UEdGraphPin* LinkedPin : Pin->LinkedTo)
-                        {
-                            if (LinkedPin && LinkedPin->GetOwningNode())
-                            {
-                                TSharedPtr<FJsonObject> ConnObj = MakeShared<FJsonObject>();
-                                ConnObj->SetStringField(TEXT("from_node"), Pin->GetOwningNode()->GetName());
-                                ConnObj->SetStringField(TEXT("from_pin"), Pin->PinName.ToString());
-                                ConnObj->SetStringField(TEXT("to_node"), LinkedPin->GetOwningNode()->GetName());
-                                ConnObj->SetStringField(TEXT("to_pin"), LinkedPin->PinName.ToString());
-                                ConnectionArray.Add(MakeShared<FJsonValueObject>(ConnObj));
-                            }
-                        }
-                        
-                        PinArray.Add(MakeShared<FJsonValueObject>(PinObj));
-                    }
-                }
-                NodeObj->SetArrayField(TEXT("pins"), PinArray);
-            }
-
-            NodeArray.Add(MakeShared<FJsonValueObject>(NodeObj));
-        }
-    }
-
-    GraphData->SetArrayField(TEXT("nodes"), NodeArray);
-    GraphData->SetArrayField(TEXT("connections"), ConnectionArray);
+    TSharedPtr<FJsonObject> GraphData = FMCPGraphSnapshot::Capture(TargetGraph).ToJson(bIncludeNodeDetails, bIncludePinConnections);
 
     TSharedPtr<FJsonObject> ResultObj = MakeShared<FJsonObject>();
     ResultObj->SetStringField(TEXT("blueprint_path"), BlueprintPath);
@@ -1460,32 +1371,7 @@ TSharedPtr<FJsonObject> FEpicUnrealMCPBlueprintCommands::HandleGetBlueprintVaria
             continue;
         }
 
-        TSharedPtr<FJsonObject> VarObj = MakeShared<FJsonObject>();
-        VarObj->SetStringField(TEXT("name"), Variable.VarName.ToString());
-        VarObj->SetStringField(TEXT("type"), Variable.VarType.PinCategory.ToString());
-        VarObj->SetStringField(TEXT("sub_category"), Variable.VarType.PinSubCategory.ToString());
-        VarObj->SetStringField(TEXT("default_value"), Variable.DefaultValue);
-        VarObj->SetStringField(TEXT("friendly_name"), Variable.FriendlyName.IsEmpty() ? Variable.VarName.ToString() : Variable.FriendlyName);
-        
-        // Get tooltip from metadata (VarTooltip doesn't exist in UE 5.5)
-        FString TooltipValue;
-        if (Variable.HasMetaData(FBlueprintMetadata::MD_Tooltip))
-        {
-            TooltipValue = Variable.GetMetaData(FBlueprintMetadata::MD_Tooltip);
-        }
-        VarObj->SetStringField(TEXT("tooltip"), TooltipValue);
-        
-        VarObj->SetStringField(TEXT("category"), Variable.Category.ToString());
-
-        // Property flags
-        VarObj->SetBoolField(TEXT("is_editable"), (Variable.PropertyFlags & CPF_Edit) != 0);
-        VarObj->SetBoolField(TEXT("is_blueprint_visible"), (Variable.PropertyFlags & CPF_BlueprintVisible) != 0);
-        VarObj->SetBoolField(TEXT("is_editable_in_instance"), (Variable.PropertyFlags & CPF_DisableEditOnInstance) == 0);
-        VarObj->SetBoolField(TEXT("is_config"), (Variable.PropertyFlags & CPF_Config) != 0);
-
-        // Replication
-        VarObj->SetNumberField(TEXT("replication"), (int32)Variable.ReplicationCondition);
-
+        TSharedPtr<FJsonObject> VarObj = FMCPBlueprintSnapshot::VariableToJson(Variable);
         VariableArray.Add(MakeShared<FJsonValueObject>(VarObj));
     }
 
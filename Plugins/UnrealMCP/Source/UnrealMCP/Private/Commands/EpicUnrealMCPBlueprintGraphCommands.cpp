@@ -1,5 +1,6 @@
 #include "Commands/EpicUnrealMCPBlueprintGraphCommands.h"
 #include "Commands/EpicUnrealMCPCommonUtils.h"
+#include "Commands/EpicUnrealMCPCommandRegistry.h"
 #include "Commands/BlueprintGraph/NodeManager.h"
 #include "Commands/BlueprintGraph/BPConnector.h"
 #include "Commands/BlueprintGraph/BPVariables.h"
@@ -17,58 +18,35 @@ FEpicUnrealMCPBlueprintGraphCommands::~FEpicUnrealMCPBlueprintGraphCommands()
 {
 }
 
-TSharedPtr<FJsonObject> FEpicUnrealMCPBlueprintGraphCommands::HandleCommand(const FString& CommandType, const TSharedPtr<FJsonObject>& Params)
+void FEpicUnrealMCPBlueprintGraphCommands::RegisterCommands(FEpicUnrealMCPCommandRegistry& Registry)
 {
-    if (CommandType == TEXT("add_blueprint_node"))
-    {
-        return HandleAddBlueprintNode(Params);
-    }
-    else if (CommandType == TEXT("connect_nodes"))
-    {
-        return HandleConnectNodes(Params);
-    }
-    else if (CommandType == TEXT("create_variable"))
-    {
-        return HandleCreateVariable(Params);
-    }
-    else if (CommandType == TEXT("set_blueprint_variable_properties"))
-    {
-        return HandleSetVariableProperties(Params);
-    }
-    else if (CommandType == TEXT("add_event_node"))
-    {
-        return HandleAddEventNode(Params);
-    }
-    else if (CommandType == TEXT("delete_node"))
-    {
-        return HandleDeleteNode(Params);
-    }
-    else if (CommandType == TEXT("set_node_property"))
-    {
-        return HandleSetNodeProperty(Params);
-    }
-    else if (CommandType == TEXT("create_function"))
-    {
-        return HandleCreateFunction(Params);
-    }
-    else if (CommandType == TEXT("add_function_input"))
-    {
-        return HandleAddFunctionInput(Params);
-    }
-    else if (CommandType == TEXT("add_function_output"))
-    {
-        return HandleAddFunctionOutput(Params);
-    }
-    else if (CommandType == TEXT("delete_function"))
-    {
-        return HandleDeleteFunction(Params);
-    }
-    else if (CommandType == TEXT("rename_function"))
-    {
-        return HandleRenameFunction(Params);
-    }
-
-    return FEpicUnrealMCPCommonUtils::CreateErrorResponse(FString::Printf(TEXT("Unknown blueprint graph command: %s"), *CommandType));
+    const FString Category = TEXT("blueprint_graph");
+    const EMCPCommandFlags WriteFlags = EMCPCommandFlags::GameThread | EMCPCommandFlags::Batchable;
+
+    Registry.Register(TEXT("add_blueprint_node"), Category, WriteFlags,
+        FMCPCommandHandler::CreateRaw(this, &FEpicUnrealMCPBlueprintGraphCommands::HandleAddBlueprintNode));
+    Registry.Register(TEXT("connect_nodes"), Category, WriteFlags,
+        FMCPCommandHandler::CreateRaw(this, &FEpicUnrealMCPBlueprintGraphCommands::HandleConnectNodes));
+    Registry.Register(TEXT("create_variable"), Category, WriteFlags,
+        FMCPCommandHandler::CreateRaw(this, &FEpicUnrealMCPBlueprintGraphCommands::HandleCreateVariable));
+    Registry.Register(TEXT("set_blueprint_variable_properties"), Category, WriteFlags,
+        FMCPCommandHandler::CreateRaw(this, &FEpicUnrealMCPBlueprintGraphCommands::HandleSetVariableProperties));
+    Registry.Register(TEXT("add_event_node"), Category, WriteFlags,
+        FMCPCommandHandler::CreateRaw(this, &FEpicUnrealMCPBlueprintGraphCommands::HandleAddEventNode));
+    Registry.Register(TEXT("delete_node"), Category, WriteFlags,
+        FMCPCommandHandler::CreateRaw(this, &FEpicUnrealMCPBlueprintGraphCommands::HandleDeleteNode));
+    Registry.Register(TEXT("set_node_property"), Category, WriteFlags,
+        FMCPCommandHandler::CreateRaw(this, &FEpicUnrealMCPBlueprintGraphCommands::HandleSetNodeProperty));
+    Registry.Register(TEXT("create_function"), Category, WriteFlags,
+        FMCPCommandHandler::CreateRaw(this, &FEpicUnrealMCPBlueprintGraphCommands::HandleCreateFunction));
+    Registry.Register(TEXT("add_function_input"), Category, WriteFlags,
+        FMCPCommandHandler::CreateRaw(this, &FEpicUnrealMCPBlueprintGraphCommands::HandleAddFunctionInput));
+    Registry.Register(TEXT("add_function_output"), Category, WriteFlags,
+        FMCPCommandHandler::CreateRaw(this, &FEpicUnrealMCPBlueprintGraphCommands::HandleAddFunctionOutput));
+    Registry.Register(TEXT("delete_function"), Category, WriteFlags,
+        FMCPCommandHandler::CreateRaw(this, &FEpicUnrealMCPBlueprintGraphCommands::HandleDeleteFunction));
+    Registry.Register(TEXT("rename_function"), Category, WriteFlags,
+        FMCPCommandHandler::CreateRaw(this, &FEpicUnrealMCPBlueprintGraphCommands::HandleRenameFunction));
 }
 
 TSharedPtr<FJsonObject> FEpicUnrealMCPBlueprintGraphCommands::HandleAddBlueprintNode(const TSharedPtr<FJsonObject>& Params)
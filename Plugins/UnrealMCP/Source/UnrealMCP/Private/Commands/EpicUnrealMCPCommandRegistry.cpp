@@ -0,0 +1,52 @@
+#include "Commands/EpicUnrealMCPCommandRegistry.h"
+
+void FEpicUnrealMCPCommandRegistry::Register(const TCHAR* Name, const FString& Category, EMCPCommandFlags Flags, FMCPCommandHandler Handler)
+{
+    FName CommandName(Name);
+    ensureMsgf(!Commands.Contains(CommandName), TEXT("MCP command %s registered twice"), Name);
+
+    FMCPCommandInfo& Info = Commands.Add(CommandName);
+    Info.Name = CommandName;
+    Info.Category = Category;
+    Info.Flags = Flags;
+    Info.Handler = MoveTemp(Handler);
+}
+
+const FMCPCommandInfo* FEpicUnrealMCPCommandRegistry::Find(const FString& CommandType) const
+{
+    FName CommandName(*CommandType, FNAME_Find);
+    if (CommandName.IsNone())
+    {
+        return nullptr;
+    }
+    return Commands.Find(CommandName);
+}
+
+TSharedPtr<FJsonObject> FEpicUnrealMCPCommandRegistry::DescribeCommands() const
+{
+    TArray<const FMCPCommandInfo*> SortedCommands;
+    for (const TPair<FName, FMCPCommandInfo>& Pair : Commands)
+    {
+        SortedCommands.Add(&Pair.Value);
+    }
+    SortedCommands.Sort([](const FMCPCommandInfo& A, const FMCPCommandInfo& B)
+    {
+        return A.Name.LexicalLess(B.Name);
+    });
+
+    TArray<TSharedPtr<FJsonValue>> CommandArray;
+    for (const FMCPCommandInfo* Info : SortedCommands)
+    {
+        TSharedPtr<FJsonObject> CommandObj = MakeShared<FJsonObject>();
+        CommandObj->SetStringField(TEXT("name"), Info->Name.ToString());
+        CommandObj->SetStringField(TEXT("category"), Info->Category);
+        CommandObj->SetBoolField(TEXT("game_thread"), Info->HasAnyFlags(EMCPCommandFlags::GameThread));
+        CommandObj->SetBoolField(TEXT("read_only"), Info->HasAnyFlags(EMCPCommandFlags::ReadOnly));
+        CommandObj->SetBoolField(TEXT("batchable"), Info->HasAnyFlags(EMCPCommandFlags::Batchable));
+        CommandArray.Add(MakeShared<FJsonValueObject>(CommandObj));
+    }
+
+    TSharedPtr<FJsonObject> ResultObj = MakeShared<FJsonObject>();
+    ResultObj->SetArrayField(TEXT("commands"), CommandArray);
+    return ResultObj;
+}
@@ -1,5 +1,6 @@
 #include "Commands/EpicUnrealMCPEditorCommands.h"
 #include "Commands/EpicUnrealMCPCommonUtils.h"
+#include "Commands/EpicUnrealMCPCommandRegistry.h"
 #include "Editor.h"
 #include "EditorViewportClient.h"
 #include "LevelEditorViewport.h"
@@ -21,42 +22,28 @@
 #include "Engine/Blueprint.h"
 #include "Engine/BlueprintGeneratedClass.h"
 #include "EditorAssetLibrary.h"
-#include "Commands/EpicUnrealMCPBlueprintCommands.h"
 
 FEpicUnrealMCPEditorCommands::FEpicUnrealMCPEditorCommands()
 {
 }
 
-TSharedPtr<FJsonObject> FEpicUnrealMCPEditorCommands::HandleCommand(const FString& CommandType, const TSharedPtr<FJsonObject>& Params)
+void FEpicUnrealMCPEditorCommands::RegisterCommands(FEpicUnrealMCPCommandRegistry& Registry)
 {
+    const FString Category = TEXT("editor");
+    const EMCPCommandFlags ReadFlags = EMCPCommandFlags::GameThread | EMCPCommandFlags::ReadOnly | EMCPCommandFlags::Batchable;
+    const EMCPCommandFlags WriteFlags = EMCPCommandFlags::GameThread | EMCPCommandFlags::Batchable;
+
     // Actor manipulation commands
-    if (CommandType == TEXT("get_actors_in_level"))
-    {
-        return HandleGetActorsInLevel(Params);
-    }
-    else if (CommandType == TEXT("find_actors_by_name"))
-    {
-        return HandleFindActorsByName(Params);
-    }
-    else if (CommandType == TEXT("spawn_actor"))
-    {
-        return HandleSpawnActor(Params);
-    }
-    else if (CommandType == TEXT("delete_actor"))
-    {
-        return HandleDeleteActor(Params);
-    }
-    else if (CommandType == TEXT("set_actor_transform"))
-    {
-        return HandleSetActorTransform(Params);
-    }
-    // Blueprint actor spawning
-    else if (CommandType == TEXT("spawn_blueprint_actor"))
-    {
-        return HandleSpawnBlueprintActor(Params);
-    }
-    
-    return FEpicUnrealMCPCommonUtils::CreateErrorResponse(FString::Printf(TEXT("Unknown editor command: %s"), *CommandType));
+    Registry.Register(TEXT("get_actors_in_level"), Category, ReadFlags,
+        FMCPCommandHandler::CreateRaw(this, &FEpicUnrealMCPEditorCommands::HandleGetActorsInLevel));
+    Registry.Register(TEXT("find_actors_by_name"), Category, ReadFlags,
+        FMCPCommandHandler::CreateRaw(this, &FEpicUnrealMCPEditorCommands::HandleFindActorsByName));
+    Registry.Register(TEXT("spawn_actor"), Category, WriteFlags,
+        FMCPCommandHandler::CreateRaw(this, &FEpicUnrealMCPEditorCommands::HandleSpawnActor));
+    Registry.Register(TEXT("delete_actor"), Category, WriteFlags,
+        FMCPCommandHandler::CreateRaw(this, &FEpicUnrealMCPEditorCommands::HandleDeleteActor));
+    Registry.Register(TEXT("set_actor_transform"), Category, WriteFlags,
+        FMCPCommandHandler::CreateRaw(this, &FEpicUnrealMCPEditorCommands::HandleSetActorTransform));
 }
 
 TSharedPtr<FJsonObject> FEpicUnrealMCPEditorCommands::HandleGetActorsInLevel(const TSharedPtr<FJsonObject>& Params)
@@ -299,10 +286,3 @@ TSharedPtr<FJsonObject> FEpicUnrealMCPEditorCommands::HandleSetActorTransform(co
     // Return updated actor info
     return FEpicUnrealMCPCommonUtils::ActorToJsonObject(TargetActor, true);
 }
-
-TSharedPtr<FJsonObject> FEpicUnrealMCPEditorCommands::HandleSpawnBlueprintActor(const TSharedPtr<FJsonObject>& Params)
-{
-    // This function will now correctly call the implementation in BlueprintCommands
-    FEpicUnrealMCPBlueprintCommands BlueprintCommands;
-    return BlueprintCommands.HandleCommand(TEXT("spawn_blueprint_actor"), Params);
-}
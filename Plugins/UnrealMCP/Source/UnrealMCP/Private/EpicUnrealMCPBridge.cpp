@@ -1,5 +1,6 @@
 #include "EpicUnrealMCPBridge.h"
 #include "MCPServerRunnable.h"
+#include "MCPEditorSnapshot.h"
 #include "Sockets.h"
 #include "SocketSubsystem.h"
 #include "HAL/RunnableThread.h"
@@ -22,6 +23,9 @@
 #include "Engine/Selection.h"
 #include "Kismet/GameplayStatics.h"
 #include "Async/Async.h"
+#include "ScopedTransaction.h"
+#include "Editor.h"
+#include "Editor/Transactor.h"
 // Add Blueprint related includes
 #include "Engine/Blueprint.h"
 #include "Engine/BlueprintGeneratedClass.h"
@@ -65,6 +69,18 @@ UEpicUnrealMCPBridge::UEpicUnrealMCPBridge()
     EditorCommands = MakeShared<FEpicUnrealMCPEditorCommands>();
     BlueprintCommands = MakeShared<FEpicUnrealMCPBlueprintCommands>();
     BlueprintGraphCommands = MakeShared<FEpicUnrealMCPBlueprintGraphCommands>();
+
+    // Handlers are bound once here, commands are then found with a single name lookup
+    CommandRegistry.Register(TEXT("ping"), TEXT("server"), EMCPCommandFlags::ReadOnly | EMCPCommandFlags::Batchable,
+        FMCPCommandHandler::CreateUObject(this, &UEpicUnrealMCPBridge::HandlePing));
+    CommandRegistry.Register(TEXT("list_commands"), TEXT("server"), EMCPCommandFlags::ReadOnly | EMCPCommandFlags::Batchable,
+        FMCPCommandHandler::CreateUObject(this, &UEpicUnrealMCPBridge::HandleListCommands));
+    CommandRegistry.Register(TEXT("batch"), TEXT("server"), EMCPCommandFlags::GameThread,
+        FMCPCommandHandler::CreateUObject(this, &UEpicUnrealMCPBridge::HandleNestedBatch));
+
+    EditorCommands->RegisterCommands(CommandRegistry);
+    BlueprintCommands->RegisterCommands(CommandRegistry);
+    BlueprintGraphCommands->RegisterCommands(CommandRegistry);
 }
 
 UEpicUnrealMCPBridge::~UEpicUnrealMCPBridge()
@@ -86,6 +102,9 @@ void UEpicUnrealMCPBridge::Initialize(FSubsystemCollectionBase& Collection)
     Port = MCP_SERVER_PORT;
     FIPv4Address::Parse(MCP_SERVER_HOST, ServerAddress);
 
+    EditorSnapshot = MakeShared<FMCPEditorSnapshot>();
+    EditorSnapshot->Initialize();
+
     // Start the server automatically
     StartServer();
 }
@@ -95,6 +114,13 @@ void UEpicUnrealMCPBridge::Deinitialize()
 {
     UE_LOG(LogTemp, Display, TEXT("EpicUnrealMCPBridge: Shutting down"));
     StopServer();
+
+    // Client threads are stopped, nothing reads the snapshot anymore
+    if (EditorSnapshot.IsValid())
+    {
+        EditorSnapshot->Deinitialize();
+        EditorSnapshot.Reset();
+    }
 }
 
 // Start the MCP server
@@ -203,114 +229,311 @@ FString UEpicUnrealMCPBridge::ExecuteCommand(const FString& CommandType, const T
     TPromise<FString> Promise;
     TFuture<FString> Future = Promise.GetFuture();
     
+    TSharedPtr<FJsonObject> ResponseJson;
+    if (TryRunOffGameThread(CommandType, Params, ResponseJson))
+    {
+        return SerializeResponse(ResponseJson, nullptr);
+    }
+
     // Queue execution on Game Thread
     AsyncTask(ENamedThreads::GameThread, [this, CommandType, Params, Promise = MoveTemp(Promise)]() mutable
     {
-        TSharedPtr<FJsonObject> ResponseJson = MakeShareable(new FJsonObject);
-        
-        try
+        Promise.SetValue(SerializeResponse(RunCommand(CommandType, Params), nullptr));
+    });
+    
+    return Future.Get();
+}
+
+// Execute pipelined commands in one game thread round trip
+TFuture<void> UEpicUnrealMCPBridge::ExecuteCommandsAsync(TArray<FMCPCommandRequest> Requests, TFunction<void(FString&&)> OnResponse)
+{
+    UE_LOG(LogTemp, Display, TEXT("EpicUnrealMCPBridge: Executing %d command(s)"), Requests.Num());
+
+    // Answer requests up to the first one that needs the game thread right here, responses have to stay in order
+    int32 NumAnswered = 0;
+    for (const FMCPCommandRequest& Request : Requests)
+    {
+        TSharedPtr<FJsonObject> ResponseJson;
+        if (Request.CommandType == TEXT("batch") || !TryRunOffGameThread(Request.CommandType, Request.Params, ResponseJson))
         {
-            TSharedPtr<FJsonObject> ResultJson;
-            
-            if (CommandType == TEXT("ping"))
+            break;
+        }
+
+        OnResponse(SerializeResponse(ResponseJson, Request.RequestId));
+        NumAnswered++;
+    }
+    Requests.RemoveAt(0, NumAnswered);
+
+    TPromise<void> Promise;
+    TFuture<void> Future = Promise.GetFuture();
+
+    if (Requests.Num() == 0)
+    {
+        Promise.SetValue();
+        return Future;
+    }
+
+    // Connections stop waiting on the group when the server shuts down, so this may only run after StopServer or Deinitialize
+    TWeakObjectPtr<UEpicUnrealMCPBridge> WeakBridge(this);
+    auto RunRequests = [WeakBridge, Requests = MoveTemp(Requests), OnResponse = MoveTemp(OnResponse), Promise = MoveTemp(Promise)]() mutable
+    {
+        UEpicUnrealMCPBridge* Bridge = WeakBridge.Get();
+        if (Bridge == nullptr || !Bridge->bIsRunning)
+        {
+            UE_LOG(LogTemp, Display, TEXT("EpicUnrealMCPBridge: Server stopped, skipping %d command(s)"), Requests.Num());
+            Promise.SetValue();
+            return;
+        }
+
+        for (const FMCPCommandRequest& Request : Requests)
+        {
+            if (Request.CommandType == TEXT("batch"))
             {
-                ResultJson = MakeShareable(new FJsonObject);
-                ResultJson->SetStringField(TEXT("message"), TEXT("pong"));
+                Bridge->ExecuteBatchOnGameThread(Request, OnResponse);
+                continue;
             }
-            // Editor Commands (including actor manipulation)
-            else if (CommandType == TEXT("get_actors_in_level") || 
-                     CommandType == TEXT("find_actors_by_name") ||
-                     CommandType == TEXT("spawn_actor") ||
-                     CommandType == TEXT("delete_actor") || 
-                     CommandType == TEXT("set_actor_transform") ||
-                     CommandType == TEXT("spawn_blueprint_actor"))
+
+            OnResponse(SerializeResponse(Bridge->RunCommand(Request.CommandType, Request.Params), Request.RequestId));
+        }
+
+        Promise.SetValue();
+    };
+
+    AsyncTask(ENamedThreads::GameThread, MoveTemp(RunRequests));
+    return Future;
+}
+
+// Run the sub-commands of a batch, optionally as one undoable transaction
+void UEpicUnrealMCPBridge::ExecuteBatchOnGameThread(const FMCPCommandRequest& Request, const TFunction<void(FString&&)>& OnResponse)
+{
+    const TArray<TSharedPtr<FJsonValue>>* Commands = nullptr;
+    if (!Request.Params.IsValid() || !Request.Params->TryGetArrayField(TEXT("commands"), Commands))
+    {
+        OnResponse(SerializeResponse(MakeErrorResponse(TEXT("Missing 'commands' array")), Request.RequestId));
+        return;
+    }
+
+    FString TransactionName;
+    Request.Params->TryGetStringField(TEXT("transaction"), TransactionName);
+
+    bool bStopOnError = false;
+    Request.Params->TryGetBoolField(TEXT("stop_on_error"), bStopOnError);
+
+    int32 NumSucceeded = 0;
+    int32 NumFailed = 0;
+    int32 NumSkipped = 0;
+
+    const FText TransactionTitle = FText::FromString(TransactionName);
+
+    {
+        // The whole batch becomes a single undo step
+        TUniquePtr<FScopedTransaction> Transaction;
+        if (!TransactionName.IsEmpty())
+        {
+            Transaction = MakeUnique<FScopedTransaction>(TransactionTitle);
+        }
+
+        for (int32 Index = 0; Index < Commands->Num(); ++Index)
+        {
+            const TSharedPtr<FJsonObject>* Command = nullptr;
+            FString CommandType;
+            TSharedPtr<FJsonObject> ResponseJson;
+
+            const FMCPCommandInfo* CommandInfo = nullptr;
+
+            if (!(*Commands)[Index]->TryGetObject(Command) || !(*Command)->TryGetStringField(TEXT("type"), CommandType))
             {
-                ResultJson = EditorCommands->HandleCommand(CommandType, Params);
+                ResponseJson = MakeErrorResponse(TEXT("Batched command is missing its 'type'"));
+                NumFailed++;
             }
-            // Blueprint Commands
-            else if (CommandType == TEXT("create_blueprint") ||
-                     CommandType == TEXT("add_component_to_blueprint") ||
-                     CommandType == TEXT("set_physics_properties") ||
-                     CommandType == TEXT("compile_blueprint") ||
-                     CommandType == TEXT("set_static_mesh_properties") ||
-                     CommandType == TEXT("set_mesh_material_color") ||
-                     CommandType == TEXT("get_available_materials") ||
-                     CommandType == TEXT("apply_material_to_actor") ||
-                     CommandType == TEXT("apply_material_to_blueprint") ||
-                     CommandType == TEXT("get_actor_material_info") ||
-                     CommandType == TEXT("get_blueprint_material_info") ||
-                     CommandType == TEXT("read_blueprint_content") ||
-                     CommandType == TEXT("analyze_blueprint_graph") ||
-                     CommandType == TEXT("get_blueprint_variable_details") ||
-                     CommandType == TEXT("get_blueprint_function_details"))
+            else if ((CommandInfo = CommandRegistry.Find(CommandType)) != nullptr && !CommandInfo->HasAnyFlags(EMCPCommandFlags::Batchable))
             {
-                ResultJson = BlueprintCommands->HandleCommand(CommandType, Params);
+                ResponseJson = MakeErrorResponse(FString::Printf(TEXT("%s can't be used inside a batch"), *CommandType));
+                NumFailed++;
             }
-            // Blueprint Graph Commands
-            else if (CommandType == TEXT("add_blueprint_node") ||
-                     CommandType == TEXT("connect_nodes") ||
-                     CommandType == TEXT("create_variable") ||
-                     CommandType == TEXT("set_blueprint_variable_properties") ||
-                     CommandType == TEXT("add_event_node") ||
-                     CommandType == TEXT("delete_node") ||
-                     CommandType == TEXT("set_node_property") ||
-                     CommandType == TEXT("create_function") ||
-                     CommandType == TEXT("add_function_input") ||
-                     CommandType == TEXT("add_function_output") ||
-                     CommandType == TEXT("delete_function") ||
-                     CommandType == TEXT("rename_function"))
+            else if (bStopOnError && NumFailed > 0)
             {
-                ResultJson = BlueprintGraphCommands->HandleCommand(CommandType, Params);
+                ResponseJson = MakeErrorResponse(TEXT("Skipped after an earlier command failed"));
+                NumSkipped++;
             }
             else
             {
-                ResponseJson->SetStringField(TEXT("status"), TEXT("error"));
-                ResponseJson->SetStringField(TEXT("error"), FString::Printf(TEXT("Unknown command: %s"), *CommandType));
-                
-                FString ResultString;
-                TSharedRef<TJsonWriter<>> Writer = TJsonWriterFactory<>::Create(&ResultString);
-                FJsonSerializer::Serialize(ResponseJson.ToSharedRef(), Writer);
-                Promise.SetValue(ResultString);
-                return;
-            }
-            
-            // Check if the result contains an error
-            bool bSuccess = true;
-            FString ErrorMessage;
-            
-            if (ResultJson->HasField(TEXT("success")))
-            {
-                bSuccess = ResultJson->GetBoolField(TEXT("success"));
-                if (!bSuccess && ResultJson->HasField(TEXT("error")))
+                const TSharedPtr<FJsonObject>* Params = nullptr;
+                (*Command)->TryGetObjectField(TEXT("params"), Params);
+
+                ResponseJson = RunCommand(CommandType, Params ? *Params : MakeShared<FJsonObject>());
+                if (ResponseJson->GetStringField(TEXT("status")) == TEXT("success"))
                 {
-                    ErrorMessage = ResultJson->GetStringField(TEXT("error"));
+                    NumSucceeded++;
+                }
+                else
+                {
+                    NumFailed++;
                 }
             }
-            
-            if (bSuccess)
-            {
-                // Set success status and include the result
-                ResponseJson->SetStringField(TEXT("status"), TEXT("success"));
-                ResponseJson->SetObjectField(TEXT("result"), ResultJson);
-            }
-            else
-            {
-                // Set error status and include the error message
-                ResponseJson->SetStringField(TEXT("status"), TEXT("error"));
-                ResponseJson->SetStringField(TEXT("error"), ErrorMessage);
-            }
+
+            // Streamed right away so the client sees progress on long batches
+            ResponseJson->SetNumberField(TEXT("batch_index"), Index);
+            OnResponse(SerializeResponse(ResponseJson, Command ? (*Command)->TryGetField(TEXT("id")) : nullptr));
         }
-        catch (const std::exception& e)
+    }
+
+    // Cancelling the transaction would only drop the undo record, the edits of the commands that succeeded have to be undone.
+    // The title check makes sure the step being undone is this batch's, nothing is recorded when no command changed anything
+    bool bRolledBack = false;
+    if (!TransactionName.IsEmpty() && NumFailed > 0 && NumSucceeded > 0 && GEditor && GEditor->Trans)
+    {
+        if (GEditor->Trans->GetUndoContext().Title.EqualTo(TransactionTitle))
         {
-            ResponseJson->SetStringField(TEXT("status"), TEXT("error"));
-            ResponseJson->SetStringField(TEXT("error"), UTF8_TO_TCHAR(e.what()));
+            bRolledBack = GEditor->UndoTransaction();
         }
-        
-        FString ResultString;
-        TSharedRef<TJsonWriter<>> Writer = TJsonWriterFactory<>::Create(&ResultString);
-        FJsonSerializer::Serialize(ResponseJson.ToSharedRef(), Writer);
-        Promise.SetValue(ResultString);
-    });
+    }
+
+    TSharedPtr<FJsonObject> ResultJson = MakeShared<FJsonObject>();
+    ResultJson->SetNumberField(TEXT("succeeded"), NumSucceeded);
+    ResultJson->SetNumberField(TEXT("failed"), NumFailed);
+    ResultJson->SetNumberField(TEXT("skipped"), NumSkipped);
+    ResultJson->SetBoolField(TEXT("rolled_back"), bRolledBack);
+
+    TSharedPtr<FJsonObject> ResponseJson = MakeShared<FJsonObject>();
+    ResponseJson->SetStringField(TEXT("status"), NumFailed == 0 ? TEXT("success") : TEXT("error"));
+    if (NumFailed > 0)
+    {
+        ResponseJson->SetStringField(TEXT("error"), FString::Printf(TEXT("%d of %d batched commands failed"), NumFailed, Commands->Num()));
+    }
+    ResponseJson->SetObjectField(TEXT("result"), ResultJson);
+    OnResponse(SerializeResponse(ResponseJson, Request.RequestId));
+}
+
+TSharedPtr<FJsonObject> UEpicUnrealMCPBridge::RunCommand(const FString& CommandType, const TSharedPtr<FJsonObject>& Params)
+{
+    const FMCPCommandInfo* Command = CommandRegistry.Find(CommandType);
+    if (!Command)
+    {
+        return MakeErrorResponse(FString::Printf(TEXT("Unknown command: %s"), *CommandType));
+    }
+
+    check(IsInGameThread() || !Command->HasAnyFlags(EMCPCommandFlags::GameThread));
+
+    TSharedPtr<FJsonObject> ResponseJson;
     
-    return Future.Get();
-}
\ No newline at end of file
+    try
+    {
+        ResponseJson = MakeCommandResponse(Command->Handler.Execute(Params));
+    }
+    catch (const std::exception& e)
+    {
+        ResponseJson = MakeErrorResponse(UTF8_TO_TCHAR(e.what()));
+    }
+
+    // Anything that may have edited the level or a Blueprint is captured again before the next snapshot read
+    if (!Command->HasAnyFlags(EMCPCommandFlags::ReadOnly) && EditorSnapshot.IsValid())
+    {
+        EditorSnapshot->InvalidateAll();
+    }
+    
+    return ResponseJson;
+}
+
+TSharedPtr<FJsonObject> UEpicUnrealMCPBridge::MakeCommandResponse(const TSharedPtr<FJsonObject>& ResultJson)
+{
+    TSharedPtr<FJsonObject> ResponseJson = MakeShareable(new FJsonObject);
+
+    // Check if the result contains an error
+    bool bSuccess = true;
+    FString ErrorMessage;
+    
+    if (ResultJson->HasField(TEXT("success")))
+    {
+        bSuccess = ResultJson->GetBoolField(TEXT("success"));
+        if (!bSuccess && ResultJson->HasField(TEXT("error")))
+        {
+            ErrorMessage = ResultJson->GetStringField(TEXT("error"));
+        }
+    }
+    
+    if (bSuccess)
+    {
+        // Set success status and include the result
+        ResponseJson->SetStringField(TEXT("status"), TEXT("success"));
+        ResponseJson->SetObjectField(TEXT("result"), ResultJson);
+    }
+    else
+    {
+        // Set error status and include the error message
+        ResponseJson->SetStringField(TEXT("status"), TEXT("error"));
+        ResponseJson->SetStringField(TEXT("error"), ErrorMessage);
+    }
+
+    return ResponseJson;
+}
+
+bool UEpicUnrealMCPBridge::RequiresGameThread(const FString& CommandType) const
+{
+    // Unknown commands are answered with an error wherever they run
+    const FMCPCommandInfo* Command = CommandRegistry.Find(CommandType);
+    return Command && Command->HasAnyFlags(EMCPCommandFlags::GameThread);
+}
+
+bool UEpicUnrealMCPBridge::TryRunOffGameThread(const FString& CommandType, const TSharedPtr<FJsonObject>& Params, TSharedPtr<FJsonObject>& OutResponse)
+{
+    if (!RequiresGameThread(CommandType))
+    {
+        OutResponse = RunCommand(CommandType, Params);
+        return true;
+    }
+
+    const FMCPCommandInfo* Command = CommandRegistry.Find(CommandType);
+    if (!Command->HasAnyFlags(EMCPCommandFlags::ReadOnly) || !EditorSnapshot.IsValid())
+    {
+        return false;
+    }
+
+    TSharedPtr<FJsonObject> ResultJson;
+    if (!EditorSnapshot->TryAnswer(CommandType, Params, ResultJson))
+    {
+        return false;
+    }
+
+    OutResponse = MakeCommandResponse(ResultJson);
+    return true;
+}
+
+TSharedPtr<FJsonObject> UEpicUnrealMCPBridge::HandlePing(const TSharedPtr<FJsonObject>& Params)
+{
+    TSharedPtr<FJsonObject> ResultJson = MakeShareable(new FJsonObject);
+    ResultJson->SetStringField(TEXT("message"), TEXT("pong"));
+    return ResultJson;
+}
+
+TSharedPtr<FJsonObject> UEpicUnrealMCPBridge::HandleListCommands(const TSharedPtr<FJsonObject>& Params)
+{
+    return CommandRegistry.DescribeCommands();
+}
+
+TSharedPtr<FJsonObject> UEpicUnrealMCPBridge::HandleNestedBatch(const TSharedPtr<FJsonObject>& Params)
+{
+    // Only reachable through ExecuteCommand, ExecuteCommandsAsync expands batches itself
+    return FEpicUnrealMCPCommonUtils::CreateErrorResponse(TEXT("Batches can't be nested"));
+}
+
+TSharedPtr<FJsonObject> UEpicUnrealMCPBridge::MakeErrorResponse(const FString& ErrorMessage)
+{
+    TSharedPtr<FJsonObject> ResponseJson = MakeShared<FJsonObject>();
+    ResponseJson->SetStringField(TEXT("status"), TEXT("error"));
+    ResponseJson->SetStringField(TEXT("error"), ErrorMessage);
+    return ResponseJson;
+}
+
+FString UEpicUnrealMCPBridge::SerializeResponse(const TSharedPtr<FJsonObject>& ResponseJson, const TSharedPtr<FJsonValue>& RequestId)
+{
+    if (RequestId.IsValid())
+    {
+        ResponseJson->SetField(TEXT("id"), RequestId);
+    }
+
+    FString ResultString;
+    TSharedRef<TJsonWriter<>> Writer = TJsonWriterFactory<>::Create(&ResultString);
+    FJsonSerializer::Serialize(ResponseJson.ToSharedRef(), Writer);
+    return ResultString;
+}
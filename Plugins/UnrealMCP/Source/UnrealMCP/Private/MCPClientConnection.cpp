@@ -0,0 +1,381 @@
+#include "MCPClientConnection.h"
+#include "EpicUnrealMCPBridge.h"
+#include "SocketSubsystem.h"
+#include "HAL/RunnableThread.h"
+#include "HAL/IConsoleManager.h"
+#include "HAL/PlatformTime.h"
+#include "HAL/PlatformProcess.h"
+#include "HAL/Event.h"
+#include "Misc/ScopeLock.h"
+#include "Dom/JsonObject.h"
+#include "Serialization/JsonSerializer.h"
+#include "Serialization/JsonReader.h"
+
+namespace MCPClientConnection
+{
+    // Only bounds how long Stop() takes to be noticed, readiness wakes the thread immediately
+    const FTimespan WaitTime = FTimespan::FromMilliseconds(100);
+}
+
+static FAutoConsoleCommand LogLatencyCommand(
+    TEXT("MCP.LogLatency"),
+    TEXT("Prints p50/p99 MCP request latency over the last samples. Pass 'reset' to clear them."),
+    FConsoleCommandWithArgsDelegate::CreateLambda([](const TArray<FString>& Args)
+    {
+        if (Args.Num() > 0 && Args[0] == TEXT("reset"))
+        {
+            FMCPLatencyStats::Get().Reset();
+            return;
+        }
+        FMCPLatencyStats::Get().Log();
+    }));
+
+FMCPResponseChannel::FMCPResponseChannel()
+    : Event(FPlatformProcess::GetSynchEventFromPool(false))
+{
+}
+
+FMCPResponseChannel::~FMCPResponseChannel()
+{
+    FPlatformProcess::ReturnSynchEventToPool(Event);
+}
+
+void FMCPResponseChannel::Push(FString&& Response)
+{
+    Responses.Enqueue(MoveTemp(Response));
+    Event->Trigger();
+}
+
+FMCPClientConnection::FMCPClientConnection(UEpicUnrealMCPBridge* InBridge, TSharedPtr<FSocket> InSocket, int32 InClientId)
+    : Bridge(InBridge)
+    , Socket(InSocket)
+    , Thread(nullptr)
+    , ClientId(InClientId)
+    , CompletedResponses(MakeShared<FMCPResponseChannel, ESPMode::ThreadSafe>())
+    , WriteOffset(0)
+    , bConnectionLost(false)
+    , bRunning(true)
+    , bFinished(false)
+{
+}
+
+FMCPClientConnection::~FMCPClientConnection()
+{
+    Shutdown();
+}
+
+bool FMCPClientConnection::Start()
+{
+    // Readiness is driven by Wait, Recv and Send must never block the thread
+    Socket->SetNonBlocking(true);
+    Socket->SetNoDelay(true);
+    int32 SocketBufferSize = 65536;  // 64KB buffer
+    Socket->SetSendBufferSize(SocketBufferSize, SocketBufferSize);
+    Socket->SetReceiveBufferSize(SocketBufferSize, SocketBufferSize);
+
+    Thread = FRunnableThread::Create(this, *FString::Printf(TEXT("UnrealMCPClient%d"), ClientId), 0, TPri_Normal);
+    return Thread != nullptr;
+}
+
+void FMCPClientConnection::Shutdown()
+{
+    if (Thread)
+    {
+        Thread->Kill(true);
+        delete Thread;
+        Thread = nullptr;
+    }
+}
+
+uint32 FMCPClientConnection::Run()
+{
+    UE_LOG(LogTemp, Display, TEXT("MCPClientConnection: Client %d connected"), ClientId);
+    FMCPLatencyStats::Get().NumClients++;
+
+    while (bRunning)
+    {
+        if (!Socket->Wait(ESocketWaitConditions::WaitForRead, MCPClientConnection::WaitTime))
+        {
+            if (Socket->GetConnectionState() == SCS_ConnectionError)
+            {
+                UE_LOG(LogTemp, Warning, TEXT("MCPClientConnection: Client %d connection error"), ClientId);
+                break;
+            }
+            continue;
+        }
+
+        if (!ReceiveAvailable())
+        {
+            break;
+        }
+
+        bool bFramingValid = ProcessReadBuffer();
+
+        // Responses to everything before an invalid message still go out
+        if (!FlushWriteQueue() || !bFramingValid)
+        {
+            break;
+        }
+
+        RecordLatencySamples();
+    }
+
+    Socket->Close();
+    FMCPLatencyStats::Get().NumClients--;
+    UE_LOG(LogTemp, Display, TEXT("MCPClientConnection: Client %d disconnected"), ClientId);
+
+    bFinished = true;
+    return 0;
+}
+
+void FMCPClientConnection::Stop()
+{
+    bRunning = false;
+}
+
+bool FMCPClientConnection::ReceiveAvailable()
+{
+    bool bReceivedAny = false;
+
+    while (true)
+    {
+        TArrayView<uint8> WriteSpace = ReadBuffer.GetWriteSpace();
+        int32 BytesRead = 0;
+        bool bReadSuccess = Socket->Recv(WriteSpace.GetData(), WriteSpace.Num(), BytesRead);
+
+        if (bReadSuccess && BytesRead > 0)
+        {
+            ReadBuffer.CommitWrite(BytesRead);
+            bReceivedAny = true;
+            continue;
+        }
+
+        if (bReadSuccess)
+        {
+            // Readable with zero bytes means the peer closed the connection
+            if (!bReceivedAny)
+            {
+                return false;
+            }
+            break;
+        }
+
+        ESocketErrors LastError = ISocketSubsystem::Get()->GetLastErrorCode();
+        if (LastError == SE_EWOULDBLOCK || LastError == SE_EINTR)
+        {
+            break;
+        }
+
+        UE_LOG(LogTemp, Warning, TEXT("MCPClientConnection: Client %d read error %d"), ClientId, (int32)LastError);
+        return false;
+    }
+
+    return true;
+}
+
+bool FMCPClientConnection::ProcessReadBuffer()
+{
+    int32 FrameOffset = 0;
+    int32 FrameSize = 0;
+    int32 Consumed = 0;
+
+    // Pipelined messages are answered in the order they arrived
+    while (Framer.NextFrame(ReadBuffer, FrameOffset, FrameSize, Consumed))
+    {
+        PendingRequestTimes.Add(FPlatformTime::Seconds());
+        ParseMessage(ReadBuffer.Peek(FrameOffset, FrameSize, FrameScratch));
+        ReadBuffer.Consume(Consumed);
+    }
+
+    RunPendingRequests();
+
+    if (Framer.HasError())
+    {
+        UE_LOG(LogTemp, Error, TEXT("MCPClientConnection: Client %d sent an invalid stream, closing: %s"),
+               ClientId, *Framer.GetError());
+        return false;
+    }
+
+    return true;
+}
+
+void FMCPClientConnection::ParseMessage(TConstArrayView<uint8> Message)
+{
+    // Decoded straight from the UTF-8 bytes, only complete messages ever get here
+    FUtf8StringView MessageView((const UTF8CHAR*)Message.GetData(), Message.Num());
+
+    TSharedPtr<FJsonObject> JsonObject;
+    TSharedRef<TJsonReader<UTF8CHAR>> Reader = TJsonReaderFactory<UTF8CHAR>::CreateFromView(MessageView);
+    if (!FJsonSerializer::Deserialize(Reader, JsonObject) || !JsonObject.IsValid())
+    {
+        UE_LOG(LogTemp, Warning, TEXT("MCPClientConnection: Client %d sent a message that isn't valid JSON (%d bytes)"),
+               ClientId, Message.Num());
+
+        // Everything received before this message is answered first
+        RunPendingRequests();
+        QueueResponse(TEXT("{\"status\":\"error\",\"error\":\"Invalid JSON\"}"));
+        return;
+    }
+
+    // 'command' is what newline framed clients used to send
+    FString CommandType;
+    if (!JsonObject->TryGetStringField(TEXT("type"), CommandType) && !JsonObject->TryGetStringField(TEXT("command"), CommandType))
+    {
+        UE_LOG(LogTemp, Warning, TEXT("MCPClientConnection: Missing 'type' field in command"));
+        RunPendingRequests();
+        QueueResponse(TEXT("{\"status\":\"error\",\"error\":\"Missing 'type' field\"}"));
+        return;
+    }
+
+    const TSharedPtr<FJsonObject>* Params = nullptr;
+    JsonObject->TryGetObjectField(TEXT("params"), Params);
+
+    FMCPCommandRequest& Request = PendingRequests.AddDefaulted_GetRef();
+    Request.CommandType = CommandType;
+    Request.Params = Params ? *Params : MakeShared<FJsonObject>();
+    Request.RequestId = JsonObject->TryGetField(TEXT("id"));
+}
+
+void FMCPClientConnection::RunPendingRequests()
+{
+    if (PendingRequests.Num() == 0)
+    {
+        return;
+    }
+
+    UE_LOG(LogTemp, Display, TEXT("MCPClientConnection: Client %d executing %d command(s)"), ClientId, PendingRequests.Num());
+
+    TFuture<void> Done = Bridge->ExecuteCommandsAsync(MoveTemp(PendingRequests), [Channel = CompletedResponses](FString&& Response)
+    {
+        Channel->Push(MoveTemp(Response));
+    });
+    PendingRequests.Reset();
+
+    // The callback only holds the channel, so a stopping connection can leave the rest of the group behind.
+    // StopServer runs on the game thread and would otherwise wait on a group that can't run until it returns
+    while (!Done.IsReady() && bRunning)
+    {
+        CompletedResponses->Event->Wait(MCPClientConnection::WaitTime);
+        DrainCompletedResponses();
+
+        if (!bConnectionLost)
+        {
+            FlushWriteQueue();
+        }
+    }
+
+    DrainCompletedResponses();
+}
+
+void FMCPClientConnection::DrainCompletedResponses()
+{
+    FString Response;
+    while (CompletedResponses->Responses.Dequeue(Response))
+    {
+        QueueResponse(Response);
+    }
+}
+
+void FMCPClientConnection::QueueResponse(const FString& Response)
+{
+    Framer.AppendResponse(Response, WriteQueue);
+}
+
+bool FMCPClientConnection::FlushWriteQueue()
+{
+    if (bConnectionLost)
+    {
+        return false;
+    }
+
+    while (WriteOffset < WriteQueue.Num() && bRunning)
+    {
+        int32 BytesSent = 0;
+        if (Socket->Send(WriteQueue.GetData() + WriteOffset, WriteQueue.Num() - WriteOffset, BytesSent))
+        {
+            WriteOffset += BytesSent;
+            continue;
+        }
+
+        ESocketErrors LastError = ISocketSubsystem::Get()->GetLastErrorCode();
+        if (LastError != SE_EWOULDBLOCK && LastError != SE_EINTR)
+        {
+            UE_LOG(LogTemp, Error, TEXT("MCPClientConnection: Client %d failed to send response after %d/%d bytes - Error code: %d"),
+                   ClientId, WriteOffset, WriteQueue.Num(), (int32)LastError);
+            bConnectionLost = true;
+            return false;
+        }
+
+        Socket->Wait(ESocketWaitConditions::WaitForWrite, MCPClientConnection::WaitTime);
+    }
+
+    if (WriteOffset == WriteQueue.Num())
+    {
+        WriteQueue.Reset();
+        WriteOffset = 0;
+    }
+
+    return true;
+}
+
+void FMCPClientConnection::RecordLatencySamples()
+{
+    double Now = FPlatformTime::Seconds();
+    for (double RequestTime : PendingRequestTimes)
+    {
+        FMCPLatencyStats::Get().AddSample((Now - RequestTime) * 1000.0);
+    }
+    PendingRequestTimes.Reset();
+}
+
+FMCPLatencyStats& FMCPLatencyStats::Get()
+{
+    static FMCPLatencyStats Stats;
+    return Stats;
+}
+
+void FMCPLatencyStats::AddSample(double Milliseconds)
+{
+    FScopeLock ScopeLock(&Lock);
+
+    if (Samples.Num() < MaxSamples)
+    {
+        Samples.Add(Milliseconds);
+    }
+    else
+    {
+        Samples[NextSample] = Milliseconds;
+    }
+    NextSample = (NextSample + 1) % MaxSamples;
+}
+
+void FMCPLatencyStats::Log()
+{
+    TArray<double> Sorted;
+    {
+        FScopeLock ScopeLock(&Lock);
+        Sorted = Samples;
+    }
+
+    if (Sorted.Num() == 0)
+    {
+        UE_LOG(LogTemp, Display, TEXT("MCP latency: no requests recorded, %d client(s) connected"), NumClients.load());
+        return;
+    }
+
+    Sorted.Sort();
+    auto Percentile = [&Sorted](double Fraction)
+    {
+        return Sorted[FMath::Min(FMath::FloorToInt32(Fraction * Sorted.Num()), Sorted.Num() - 1)];
+    };
+
+    UE_LOG(LogTemp, Display, TEXT("MCP latency over %d requests, %d client(s) connected: p50 %.2f ms, p99 %.2f ms, max %.2f ms"),
+           Sorted.Num(), NumClients.load(), Percentile(0.5), Percentile(0.99), Sorted.Last());
+}
+
+void FMCPLatencyStats::Reset()
+{
+    FScopeLock ScopeLock(&Lock);
+    Samples.Reset();
+    NextSample = 0;
+}
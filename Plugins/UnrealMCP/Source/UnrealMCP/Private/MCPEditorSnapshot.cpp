@@ -0,0 +1,565 @@
+#include "MCPEditorSnapshot.h"
+#include "Commands/EpicUnrealMCPCommonUtils.h"
+#include "Editor.h"
+#include "EditorAssetLibrary.h"
+#include "EdGraphSchema_K2.h"
+#include "EdGraph/EdGraph.h"
+#include "EdGraph/EdGraphNode.h"
+#include "EdGraph/EdGraphPin.h"
+#include "Engine/Blueprint.h"
+#include "Engine/World.h"
+#include "GameFramework/Actor.h"
+#include "Kismet/GameplayStatics.h"
+#include "Misc/ScopeRWLock.h"
+#include "UObject/UObjectGlobals.h"
+
+namespace MCPEditorSnapshot
+{
+    // Dragging an actor or editing a graph dirties every frame, captures are spaced out while that happens
+    constexpr double MinCaptureInterval = 0.25;
+}
+
+FMCPGraphSnapshot FMCPGraphSnapshot::Capture(const UEdGraph* Graph)
+{
+    FMCPGraphSnapshot Snapshot;
+    Snapshot.Name = Graph->GetName();
+    Snapshot.ClassName = Graph->GetClass()->GetName();
+
+    for (UEdGraphNode* Node : Graph->Nodes)
+    {
+        if (!Node)
+        {
+            continue;
+        }
+
+        FMCPNodeSnapshot& NodeSnapshot = Snapshot.Nodes.AddDefaulted_GetRef();
+        NodeSnapshot.Name = Node->GetName();
+        NodeSnapshot.ClassName = Node->GetClass()->GetName();
+        NodeSnapshot.Title = Node->GetNodeTitle(ENodeTitleType::FullTitle).ToString();
+        NodeSnapshot.PosX = Node->NodePosX;
+        NodeSnapshot.PosY = Node->NodePosY;
+        NodeSnapshot.bCanRename = Node->bCanRenameNode;
+
+        for (UEdGraphPin* Pin : Node->Pins)
+        {
+            if (!Pin)
+            {
+                continue;
+            }
+
+            FMCPPinSnapshot& PinSnapshot = NodeSnapshot.Pins.AddDefaulted_GetRef();
+            PinSnapshot.Name = Pin->PinName.ToString();
+            PinSnapshot.Category = Pin->PinType.PinCategory.ToString();
+            PinSnapshot.bIsInput = Pin->Direction == EGPD_Input;
+
+            for (UEdGraphPin* LinkedPin : Pin->LinkedTo)
+            {
+                if (LinkedPin && LinkedPin->GetOwningNode())
+                {
+                    PinSnapshot.LinkedTo.Emplace(LinkedPin->GetOwningNode()->GetName(), LinkedPin->PinName.ToString());
+                }
+            }
+        }
+    }
+
+    return Snapshot;
+}
+
+TSharedPtr<FJsonObject> FMCPGraphSnapshot::ToJson(bool bIncludeNodeDetails, bool bIncludePinConnections) const
+{
+    TSharedPtr<FJsonObject> GraphData = MakeShared<FJsonObject>();
+    GraphData->SetStringField(TEXT("graph_name"), Name);
+    GraphData->SetStringField(TEXT("graph_type"), ClassName);
+
+    TArray<TSharedPtr<FJsonValue>> NodeArray;
+    TArray<TSharedPtr<FJsonValue>> ConnectionArray;
+
+    for (const FMCPNodeSnapshot& Node : Nodes)
+    {
+        TSharedPtr<FJsonObject> NodeObj = MakeShared<FJsonObject>();
+        NodeObj->SetStringField(TEXT("name"), Node.Name);
+        NodeObj->SetStringField(TEXT("class"), Node.ClassName);
+        NodeObj->SetStringField(TEXT("title"), Node.Title);
+
+        if (bIncludeNodeDetails)
+        {
+            NodeObj->SetNumberField(TEXT("pos_x"), Node.PosX);
+            NodeObj->SetNumberField(TEXT("pos_y"), Node.PosY);
+            NodeObj->SetBoolField(TEXT("can_rename"), Node.bCanRename);
+        }
+
+        // Include pin information if requested
+        if (bIncludePinConnections)
+        {
+            TArray<TSharedPtr<FJsonValue>> PinArray;
+            for (const FMCPPinSnapshot& Pin : Node.Pins)
+            {
+                TSharedPtr<FJsonObject> PinObj = MakeShared<FJsonObject>();
+                PinObj->SetStringField(TEXT("name"), Pin.Name);
+                PinObj->SetStringField(TEXT("type"), Pin.Category);
+                PinObj->SetStringField(TEXT("direction"), Pin.bIsInput ? TEXT("Input") : TEXT("Output"));
+                PinObj->SetNumberField(TEXT("connections"), Pin.LinkedTo.Num());
+
+                // Record connections for this pin
+                for (const TPair<FString, FString>& Link : Pin.LinkedTo)
+                {
+                    TSharedPtr<FJsonObject> ConnObj = MakeShared<FJsonObject>();
+                    ConnObj->SetStringField(TEXT("from_node"), Node.Name);
+                    ConnObj->SetStringField(TEXT("from_pin"), Pin.Name);
+                    ConnObj->SetStringField(TEXT("to_node"), Link.Key);
+                    ConnObj->SetStringField(TEXT("to_pin"), Link.Value);
+                    ConnectionArray.Add(MakeShared<FJsonValueObject>(ConnObj));
+                }
+
+                PinArray.Add(MakeShared<FJsonValueObject>(PinObj));
+            }
+            NodeObj->SetArrayField(TEXT("pins"), PinArray);
+        }
+
+        NodeArray.Add(MakeShared<FJsonValueObject>(NodeObj));
+    }
+
+    GraphData->SetArrayField(TEXT("nodes"), NodeArray);
+    GraphData->SetArrayField(TEXT("connections"), ConnectionArray);
+    return GraphData;
+}
+
+TSharedPtr<FJsonObject> FMCPBlueprintSnapshot::VariableToJson(const FBPVariableDescription& Variable)
+{
+    TSharedPtr<FJsonObject> VarObj = MakeShared<FJsonObject>();
+    VarObj->SetStringField(TEXT("name"), Variable.VarName.ToString());
+    VarObj->SetStringField(TEXT("type"), Variable.VarType.PinCategory.ToString());
+    VarObj->SetStringField(TEXT("sub_category"), Variable.VarType.PinSubCategory.ToString());
+    VarObj->SetStringField(TEXT("default_value"), Variable.DefaultValue);
+    VarObj->SetStringField(TEXT("friendly_name"), Variable.FriendlyName.IsEmpty() ? Variable.VarName.ToString() : Variable.FriendlyName);
+
+    // Get tooltip from metadata (VarTooltip doesn't exist in UE 5.5)
+    FString TooltipValue;
+    if (Variable.HasMetaData(FBlueprintMetadata::MD_Tooltip))
+    {
+        TooltipValue = Variable.GetMetaData(FBlueprintMetadata::MD_Tooltip);
+    }
+    VarObj->SetStringField(TEXT("tooltip"), TooltipValue);
+
+    VarObj->SetStringField(TEXT("category"), Variable.Category.ToString());
+
+    // Property flags
+    VarObj->SetBoolField(TEXT("is_editable"), (Variable.PropertyFlags & CPF_Edit) != 0);
+    VarObj->SetBoolField(TEXT("is_blueprint_visible"), (Variable.PropertyFlags & CPF_BlueprintVisible) != 0);
+    VarObj->SetBoolField(TEXT("is_editable_in_instance"), (Variable.PropertyFlags & CPF_DisableEditOnInstance) == 0);
+    VarObj->SetBoolField(TEXT("is_config"), (Variable.PropertyFlags & CPF_Config) != 0);
+
+    // Replication
+    VarObj->SetNumberField(TEXT("replication"), (int32)Variable.ReplicationCondition);
+
+    return VarObj;
+}
+
+void FMCPEditorSnapshot::Initialize()
+{
+    AnswerFunctions.Add(TEXT("get_actors_in_level"), &FMCPEditorSnapshot::AnswerGetActorsInLevel);
+    AnswerFunctions.Add(TEXT("find_actors_by_name"), &FMCPEditorSnapshot::AnswerFindActorsByName);
+    AnswerFunctions.Add(TEXT("analyze_blueprint_graph"), &FMCPEditorSnapshot::AnswerAnalyzeBlueprintGraph);
+    AnswerFunctions.Add(TEXT("get_blueprint_variable_details"), &FMCPEditorSnapshot::AnswerGetBlueprintVariableDetails);
+
+    TickerHandle = FTSTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateRaw(this, &FMCPEditorSnapshot::Tick));
+
+    if (GEngine)
+    {
+        ActorAddedHandle = GEngine->OnLevelActorAdded().AddRaw(this, &FMCPEditorSnapshot::OnActorChanged);
+        ActorDeletedHandle = GEngine->OnLevelActorDeleted().AddRaw(this, &FMCPEditorSnapshot::OnActorChanged);
+        ActorMovedHandle = GEngine->OnActorMoved().AddRaw(this, &FMCPEditorSnapshot::OnActorChanged);
+    }
+    if (GEditor)
+    {
+        BlueprintCompiledHandle = GEditor->OnBlueprintCompiled().AddRaw(this, &FMCPEditorSnapshot::InvalidateAll);
+    }
+
+    ObjectModifiedHandle = FCoreUObjectDelegates::OnObjectModified.AddRaw(this, &FMCPEditorSnapshot::OnObjectModified);
+    ObjectPropertyChangedHandle = FCoreUObjectDelegates::OnObjectPropertyChanged.AddRaw(this, &FMCPEditorSnapshot::OnObjectPropertyChanged);
+    MapChangeHandle = FEditorDelegates::MapChange.AddRaw(this, &FMCPEditorSnapshot::OnMapChange);
+    PostPIEStartedHandle = FEditorDelegates::PostPIEStarted.AddRaw(this, &FMCPEditorSnapshot::OnPIEChanged);
+    EndPIEHandle = FEditorDelegates::EndPIE.AddRaw(this, &FMCPEditorSnapshot::OnPIEChanged);
+    PostUndoRedoHandle = FEditorDelegates::PostUndoRedo.AddRaw(this, &FMCPEditorSnapshot::InvalidateAll);
+}
+
+void FMCPEditorSnapshot::Deinitialize()
+{
+    FTSTicker::GetCoreTicker().RemoveTicker(TickerHandle);
+
+    if (GEngine)
+    {
+        GEngine->OnLevelActorAdded().Remove(ActorAddedHandle);
+        GEngine->OnLevelActorDeleted().Remove(ActorDeletedHandle);
+        GEngine->OnActorMoved().Remove(ActorMovedHandle);
+    }
+    if (GEditor)
+    {
+        GEditor->OnBlueprintCompiled().Remove(BlueprintCompiledHandle);
+    }
+
+    FCoreUObjectDelegates::OnObjectModified.Remove(ObjectModifiedHandle);
+    FCoreUObjectDelegates::OnObjectPropertyChanged.Remove(ObjectPropertyChangedHandle);
+    FEditorDelegates::MapChange.Remove(MapChangeHandle);
+    FEditorDelegates::PostPIEStarted.Remove(PostPIEStartedHandle);
+    FEditorDelegates::EndPIE.Remove(EndPIEHandle);
+    FEditorDelegates::PostUndoRedo.Remove(PostUndoRedoHandle);
+
+    FWriteScopeLock WriteLock(Lock);
+    Level.Reset();
+    Blueprints.Reset();
+    RequestedBlueprints.Reset();
+}
+
+bool FMCPEditorSnapshot::TryAnswer(const FString& CommandType, const TSharedPtr<FJsonObject>& Params, TSharedPtr<FJsonObject>& OutResult)
+{
+    // AnswerFunctions is only written in Initialize
+    FName CommandName(*CommandType, FNAME_Find);
+    FAnswerFunction* AnswerFunction = CommandName.IsNone() ? nullptr : AnswerFunctions.Find(CommandName);
+    if (!AnswerFunction || !Params.IsValid())
+    {
+        return false;
+    }
+
+    return (this->**AnswerFunction)(Params, OutResult);
+}
+
+void FMCPEditorSnapshot::InvalidateAll()
+{
+    InvalidateLevel();
+
+    FWriteScopeLock WriteLock(Lock);
+    for (const TPair<FString, TSharedPtr<const FMCPBlueprintSnapshot, ESPMode::ThreadSafe>>& Pair : Blueprints)
+    {
+        RequestedBlueprints.Add(Pair.Key);
+    }
+    Blueprints.Reset();
+}
+
+bool FMCPEditorSnapshot::Tick(float DeltaTime)
+{
+    double Now = FPlatformTime::Seconds();
+
+    // PIE actors move every frame without notifications, level reads go to the game thread until it ends
+    bool bPlaying = GEditor && GEditor->PlayWorld;
+
+    if (bLevelDirty && !bPlaying && Now - LastLevelCaptureTime >= MCPEditorSnapshot::MinCaptureInterval)
+    {
+        CaptureLevel();
+        LastLevelCaptureTime = Now;
+    }
+
+    if (Now - LastBlueprintCaptureTime >= MCPEditorSnapshot::MinCaptureInterval)
+    {
+        CaptureRequestedBlueprints();
+        LastBlueprintCaptureTime = Now;
+    }
+
+    return true;
+}
+
+void FMCPEditorSnapshot::CaptureLevel()
+{
+    bLevelDirty = false;
+
+    UWorld* World = GWorld;
+    if (!World)
+    {
+        return;
+    }
+
+    TSharedPtr<FMCPLevelSnapshot, ESPMode::ThreadSafe> NewLevel = MakeShared<FMCPLevelSnapshot, ESPMode::ThreadSafe>();
+
+    TArray<AActor*> AllActors;
+    UGameplayStatics::GetAllActorsOfClass(World, AActor::StaticClass(), AllActors);
+    for (AActor* Actor : AllActors)
+    {
+        if (Actor)
+        {
+            NewLevel->ActorNames.Add(Actor->GetName());
+            NewLevel->Actors.Add(FEpicUnrealMCPCommonUtils::ActorToJson(Actor));
+        }
+    }
+
+    FWriteScopeLock WriteLock(Lock);
+    Level = NewLevel;
+}
+
+void FMCPEditorSnapshot::CaptureRequestedBlueprints()
+{
+    TSet<FString> Requested;
+    {
+        FWriteScopeLock WriteLock(Lock);
+        if (RequestedBlueprints.Num() == 0)
+        {
+            return;
+        }
+        Requested = MoveTemp(RequestedBlueprints);
+        RequestedBlueprints.Reset();
+    }
+
+    for (const FString& BlueprintPath : Requested)
+    {
+        UBlueprint* Blueprint = TrackedBlueprints.FindRef(BlueprintPath).Get();
+        if (!Blueprint)
+        {
+            Blueprint = Cast<UBlueprint>(UEditorAssetLibrary::LoadAsset(BlueprintPath));
+        }
+        if (!Blueprint)
+        {
+            TrackedBlueprints.Remove(BlueprintPath);
+            continue;
+        }
+
+        TSharedPtr<FMCPBlueprintSnapshot, ESPMode::ThreadSafe> NewBlueprint = MakeShared<FMCPBlueprintSnapshot, ESPMode::ThreadSafe>();
+
+        for (UEdGraph* Graph : Blueprint->UbergraphPages)
+        {
+            if (Graph)
+            {
+                NewBlueprint->Graphs.Add(FMCPGraphSnapshot::Capture(Graph));
+            }
+        }
+        for (UEdGraph* Graph : Blueprint->FunctionGraphs)
+        {
+            if (Graph)
+            {
+                NewBlueprint->Graphs.Add(FMCPGraphSnapshot::Capture(Graph));
+            }
+        }
+
+        for (const FBPVariableDescription& Variable : Blueprint->NewVariables)
+        {
+            NewBlueprint->VariableNames.Add(Variable.VarName.ToString());
+            NewBlueprint->Variables.Add(FMCPBlueprintSnapshot::VariableToJson(Variable));
+        }
+
+        TrackedBlueprints.Add(BlueprintPath, Blueprint);
+
+        FWriteScopeLock WriteLock(Lock);
+        Blueprints.Add(BlueprintPath, NewBlueprint);
+    }
+}
+
+void FMCPEditorSnapshot::InvalidateLevel()
+{
+    bLevelDirty = true;
+
+    FWriteScopeLock WriteLock(Lock);
+    Level.Reset();
+}
+
+void FMCPEditorSnapshot::InvalidateBlueprint(const UBlueprint* Blueprint)
+{
+    for (const TPair<FString, TWeakObjectPtr<UBlueprint>>& Pair : TrackedBlueprints)
+    {
+        if (Pair.Value.Get() == Blueprint)
+        {
+            FWriteScopeLock WriteLock(Lock);
+            if (Blueprints.Remove(Pair.Key) > 0)
+            {
+                RequestedBlueprints.Add(Pair.Key);
+            }
+        }
+    }
+}
+
+void FMCPEditorSnapshot::OnActorChanged(AActor* Actor)
+{
+    InvalidateLevel();
+}
+
+void FMCPEditorSnapshot::OnObjectModified(UObject* Object)
+{
+    if (!Object)
+    {
+        return;
+    }
+
+    if (Object->IsA<AActor>() || Object->GetTypedOuter<AActor>())
+    {
+        InvalidateLevel();
+        return;
+    }
+
+    // Graphs, nodes and pins all live inside their Blueprint
+    const UBlueprint* Blueprint = Cast<UBlueprint>(Object);
+    if (!Blueprint)
+    {
+        Blueprint = Object->GetTypedOuter<UBlueprint>();
+    }
+    if (Blueprint)
+    {
+        InvalidateBlueprint(Blueprint);
+    }
+}
+
+void FMCPEditorSnapshot::OnObjectPropertyChanged(UObject* Object, FPropertyChangedEvent& PropertyChangedEvent)
+{
+    OnObjectModified(Object);
+}
+
+void FMCPEditorSnapshot::OnMapChange(uint32 MapChangeFlags)
+{
+    InvalidateLevel();
+}
+
+void FMCPEditorSnapshot::OnPIEChanged(bool bIsSimulating)
+{
+    InvalidateLevel();
+}
+
+bool FMCPEditorSnapshot::AnswerGetActorsInLevel(const TSharedPtr<FJsonObject>& Params, TSharedPtr<FJsonObject>& OutResult)
+{
+    TSharedPtr<const FMCPLevelSnapshot, ESPMode::ThreadSafe> LevelSnapshot;
+    {
+        FReadScopeLock ReadLock(Lock);
+        LevelSnapshot = Level;
+    }
+    if (!LevelSnapshot.IsValid())
+    {
+        return false;
+    }
+
+    OutResult = MakeShared<FJsonObject>();
+    OutResult->SetArrayField(TEXT("actors"), LevelSnapshot->Actors);
+    return true;
+}
+
+bool FMCPEditorSnapshot::AnswerFindActorsByName(const TSharedPtr<FJsonObject>& Params, TSharedPtr<FJsonObject>& OutResult)
+{
+    FString Pattern;
+    if (!Params->TryGetStringField(TEXT("pattern"), Pattern))
+    {
+        OutResult = FEpicUnrealMCPCommonUtils::CreateErrorResponse(TEXT("Missing 'pattern' parameter"));
+        return true;
+    }
+
+    TSharedPtr<const FMCPLevelSnapshot, ESPMode::ThreadSafe> LevelSnapshot;
+    {
+        FReadScopeLock ReadLock(Lock);
+        LevelSnapshot = Level;
+    }
+    if (!LevelSnapshot.IsValid())
+    {
+        return false;
+    }
+
+    TArray<TSharedPtr<FJsonValue>> MatchingActors;
+    for (int32 i = 0; i < LevelSnapshot->ActorNames.Num(); ++i)
+    {
+        if (LevelSnapshot->ActorNames[i].Contains(Pattern))
+        {
+            MatchingActors.Add(LevelSnapshot->Actors[i]);
+        }
+    }
+
+    OutResult = MakeShared<FJsonObject>();
+    OutResult->SetArrayField(TEXT("actors"), MatchingActors);
+    return true;
+}
+
+bool FMCPEditorSnapshot::AnswerAnalyzeBlueprintGraph(const TSharedPtr<FJsonObject>& Params, TSharedPtr<FJsonObject>& OutResult)
+{
+    FString BlueprintPath;
+    if (!Params->TryGetStringField(TEXT("blueprint_path"), BlueprintPath))
+    {
+        return false;
+    }
+
+    TSharedPtr<const FMCPBlueprintSnapshot, ESPMode::ThreadSafe> BlueprintSnapshot = FindBlueprint(BlueprintPath);
+    if (!BlueprintSnapshot.IsValid())
+    {
+        return false;
+    }
+
+    FString GraphName = TEXT("EventGraph");
+    Params->TryGetStringField(TEXT("graph_name"), GraphName);
+
+    bool bIncludeNodeDetails = true;
+    bool bIncludePinConnections = true;
+    Params->TryGetBoolField(TEXT("include_node_details"), bIncludeNodeDetails);
+    Params->TryGetBoolField(TEXT("include_pin_connections"), bIncludePinConnections);
+
+    const FMCPGraphSnapshot* TargetGraph = BlueprintSnapshot->Graphs.FindByPredicate([&GraphName](const FMCPGraphSnapshot& Graph)
+    {
+        return Graph.Name == GraphName;
+    });
+    if (!TargetGraph)
+    {
+        OutResult = FEpicUnrealMCPCommonUtils::CreateErrorResponse(FString::Printf(TEXT("Graph not found: %s"), *GraphName));
+        return true;
+    }
+
+    OutResult = MakeShared<FJsonObject>();
+    OutResult->SetStringField(TEXT("blueprint_path"), BlueprintPath);
+    OutResult->SetObjectField(TEXT("graph_data"), TargetGraph->ToJson(bIncludeNodeDetails, bIncludePinConnections));
+    OutResult->SetBoolField(TEXT("success"), true);
+    return true;
+}
+
+bool FMCPEditorSnapshot::AnswerGetBlueprintVariableDetails(const TSharedPtr<FJsonObject>& Params, TSharedPtr<FJsonObject>& OutResult)
+{
+    FString BlueprintPath;
+    if (!Params->TryGetStringField(TEXT("blueprint_path"), BlueprintPath))
+    {
+        return false;
+    }
+
+    TSharedPtr<const FMCPBlueprintSnapshot, ESPMode::ThreadSafe> BlueprintSnapshot = FindBlueprint(BlueprintPath);
+    if (!BlueprintSnapshot.IsValid())
+    {
+        return false;
+    }
+
+    FString VariableName;
+    bool bSpecificVariable = Params->TryGetStringField(TEXT("variable_name"), VariableName);
+
+    OutResult = MakeShared<FJsonObject>();
+    OutResult->SetStringField(TEXT("blueprint_path"), BlueprintPath);
+
+    if (bSpecificVariable)
+    {
+        int32 VariableIndex = BlueprintSnapshot->VariableNames.IndexOfByPredicate([&VariableName](const FString& Name)
+        {
+            return Name == VariableName;
+        });
+        if (VariableIndex == INDEX_NONE)
+        {
+            OutResult = FEpicUnrealMCPCommonUtils::CreateErrorResponse(FString::Printf(TEXT("Variable not found: %s"), *VariableName));
+            return true;
+        }
+
+        OutResult->SetStringField(TEXT("variable_name"), VariableName);
+        OutResult->SetObjectField(TEXT("variable"), BlueprintSnapshot->Variables[VariableIndex]);
+    }
+    else
+    {
+        TArray<TSharedPtr<FJsonValue>> VariableArray;
+        for (const TSharedPtr<FJsonObject>& Variable : BlueprintSnapshot->Variables)
+        {
+            VariableArray.Add(MakeShared<FJsonValueObject>(Variable));
+        }
+        OutResult->SetArrayField(TEXT("variables"), VariableArray);
+        OutResult->SetNumberField(TEXT("variable_count"), VariableArray.Num());
+    }
+
+    OutResult->SetBoolField(TEXT("success"), true);
+    return true;
+}
+
+TSharedPtr<const FMCPBlueprintSnapshot, ESPMode::ThreadSafe> FMCPEditorSnapshot::FindBlueprint(const FString& BlueprintPath)
+{
+    {
+        FReadScopeLock ReadLock(Lock);
+        if (const TSharedPtr<const FMCPBlueprintSnapshot, ESPMode::ThreadSafe>* Found = Blueprints.Find(BlueprintPath))
+        {
+            return *Found;
+        }
+    }
+
+    // Answered on the game thread this time, captured for the next request
+    FWriteScopeLock WriteLock(Lock);
+    RequestedBlueprints.Add(BlueprintPath);
+    return nullptr;
+}
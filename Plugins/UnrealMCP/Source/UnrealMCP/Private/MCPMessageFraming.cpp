@@ -0,0 +1,231 @@
+#include "MCPMessageFraming.h"
+
+FMCPByteRingBuffer::FMCPByteRingBuffer(int32 InitialCapacity)
+    : Mask(0)
+    , Head(0)
+    , Tail(0)
+{
+    Grow(InitialCapacity);
+}
+
+TArrayView<uint8> FMCPByteRingBuffer::GetWriteSpace(int32 MinFree)
+{
+    if (Data.Num() - Num() < MinFree)
+    {
+        Grow(Num() + MinFree);
+    }
+
+    int32 WriteIndex = (int32)(Tail & Mask);
+    int32 Contiguous = FMath::Min(Data.Num() - WriteIndex, Data.Num() - Num());
+    return TArrayView<uint8>(Data.GetData() + WriteIndex, Contiguous);
+}
+
+void FMCPByteRingBuffer::CommitWrite(int32 Count)
+{
+    check(Count >= 0 && Num() + Count <= Data.Num());
+    Tail += Count;
+}
+
+TConstArrayView<uint8> FMCPByteRingBuffer::Peek(int32 Offset, int32 Count, TArray<uint8>& Scratch) const
+{
+    check(Offset >= 0 && Offset + Count <= Num());
+
+    int32 ReadIndex = (int32)((Head + Offset) & Mask);
+    int32 Contiguous = Data.Num() - ReadIndex;
+    if (Count <= Contiguous)
+    {
+        return TConstArrayView<uint8>(Data.GetData() + ReadIndex, Count);
+    }
+
+    Scratch.SetNumUninitialized(Count, EAllowShrinking::No);
+    FMemory::Memcpy(Scratch.GetData(), Data.GetData() + ReadIndex, Contiguous);
+    FMemory::Memcpy(Scratch.GetData() + Contiguous, Data.GetData(), Count - Contiguous);
+    return Scratch;
+}
+
+void FMCPByteRingBuffer::Consume(int32 Count)
+{
+    check(Count >= 0 && Count <= Num());
+    Head += Count;
+
+    // Restart at the beginning of the storage so the next Recv gets the largest contiguous space
+    if (Head == Tail)
+    {
+        Head = 0;
+        Tail = 0;
+    }
+}
+
+void FMCPByteRingBuffer::Grow(int32 MinCapacity)
+{
+    int32 NewCapacity = (int32)FMath::RoundUpToPowerOfTwo(FMath::Max(MinCapacity, 16));
+
+    TArray<uint8> NewData;
+    NewData.SetNumUninitialized(NewCapacity);
+
+    int32 Count = Num();
+    if (Count > 0)
+    {
+        TArray<uint8> Unused;
+        TConstArrayView<uint8> Existing = Peek(0, Count, Unused);
+        FMemory::Memcpy(NewData.GetData(), Existing.GetData(), Count);
+    }
+
+    Data = MoveTemp(NewData);
+    Mask = (uint64)NewCapacity - 1;
+    Head = 0;
+    Tail = Count;
+}
+
+bool FMCPMessageFramer::NextFrame(const FMCPByteRingBuffer& Buffer, int32& OutFrameOffset, int32& OutFrameSize, int32& OutConsumed)
+{
+    if (HasError() || Buffer.Num() == 0)
+    {
+        return false;
+    }
+
+    if (Framing == EMCPFraming::Unknown)
+    {
+        // Sizes up to MaxFrameSize fit in the low three bytes of the prefix, so it starts with a zero byte and JSON never does
+        Framing = Buffer[0] == 0 ? EMCPFraming::LengthPrefixed : EMCPFraming::Json;
+    }
+
+    if (Framing == EMCPFraming::LengthPrefixed)
+    {
+        return NextLengthPrefixedFrame(Buffer, OutFrameOffset, OutFrameSize, OutConsumed);
+    }
+    return NextJsonFrame(Buffer, OutFrameOffset, OutFrameSize, OutConsumed);
+}
+
+bool FMCPMessageFramer::NextJsonFrame(const FMCPByteRingBuffer& Buffer, int32& OutFrameOffset, int32& OutFrameSize, int32& OutConsumed)
+{
+    const int32 Available = Buffer.Num();
+
+    for (; ScanOffset < Available; ++ScanOffset)
+    {
+        uint8 Char = Buffer[ScanOffset];
+
+        if (FrameOffset == INDEX_NONE)
+        {
+            // Separators between messages
+            if (Char == '\n')
+            {
+                bNewlineDelimited = true;
+                continue;
+            }
+            if (Char == ' ' || Char == '\t' || Char == '\r')
+            {
+                continue;
+            }
+            if (Char != '{')
+            {
+                Error = FString::Printf(TEXT("Expected '{' at the start of a message, got byte 0x%02X"), Char);
+                return false;
+            }
+            FrameOffset = ScanOffset;
+        }
+
+        if (bInString)
+        {
+            if (bEscaped)
+            {
+                bEscaped = false;
+            }
+            else if (Char == '\\')
+            {
+                bEscaped = true;
+            }
+            else if (Char == '"')
+            {
+                bInString = false;
+            }
+            continue;
+        }
+
+        if (Char == '"')
+        {
+            bInString = true;
+        }
+        else if (Char == '{' || Char == '[')
+        {
+            ++Depth;
+        }
+        else if ((Char == '}' || Char == ']') && --Depth == 0)
+        {
+            OutFrameOffset = FrameOffset;
+            OutFrameSize = ScanOffset + 1 - FrameOffset;
+            OutConsumed = ScanOffset + 1;
+
+            // Pick up a trailing newline now so the response to this message is already framed like the request
+            if (OutConsumed < Available && Buffer[OutConsumed] == '\n')
+            {
+                bNewlineDelimited = true;
+                ++OutConsumed;
+            }
+
+            ResetScan();
+            return true;
+        }
+    }
+
+    int32 PartialSize = FrameOffset == INDEX_NONE ? 0 : Available - FrameOffset;
+    if (PartialSize > MaxFrameSize)
+    {
+        Error = FString::Printf(TEXT("Message exceeds %d bytes"), MaxFrameSize);
+    }
+    return false;
+}
+
+bool FMCPMessageFramer::NextLengthPrefixedFrame(const FMCPByteRingBuffer& Buffer, int32& OutFrameOffset, int32& OutFrameSize, int32& OutConsumed)
+{
+    const int32 HeaderSize = 4;
+    if (Buffer.Num() < HeaderSize)
+    {
+        return false;
+    }
+
+    uint32 PayloadSize = ((uint32)Buffer[0] << 24) | ((uint32)Buffer[1] << 16) | ((uint32)Buffer[2] << 8) | (uint32)Buffer[3];
+    if (PayloadSize > (uint32)MaxFrameSize)
+    {
+        Error = FString::Printf(TEXT("Message size %u exceeds %d bytes"), PayloadSize, MaxFrameSize);
+        return false;
+    }
+
+    if (Buffer.Num() < HeaderSize + (int32)PayloadSize)
+    {
+        return false;
+    }
+
+    OutFrameOffset = HeaderSize;
+    OutFrameSize = (int32)PayloadSize;
+    OutConsumed = HeaderSize + (int32)PayloadSize;
+    return true;
+}
+
+void FMCPMessageFramer::AppendResponse(const FString& Response, TArray<uint8>& OutQueue) const
+{
+    FTCHARToUTF8 UTF8Response(*Response);
+    const uint32 PayloadSize = (uint32)UTF8Response.Length();
+
+    if (Framing == EMCPFraming::LengthPrefixed)
+    {
+        const uint8 Header[4] = { (uint8)(PayloadSize >> 24), (uint8)(PayloadSize >> 16), (uint8)(PayloadSize >> 8), (uint8)PayloadSize };
+        OutQueue.Append(Header, 4);
+    }
+
+    OutQueue.Append((const uint8*)UTF8Response.Get(), PayloadSize);
+
+    if (Framing == EMCPFraming::Json && bNewlineDelimited)
+    {
+        OutQueue.Add('\n');
+    }
+}
+
+void FMCPMessageFramer::ResetScan()
+{
+    ScanOffset = 0;
+    FrameOffset = INDEX_NONE;
+    Depth = 0;
+    bInString = false;
+    bEscaped = false;
+}
@@ -3,6 +3,8 @@
 #include "CoreMinimal.h"
 #include "Json.h"
 
+class FEpicUnrealMCPCommandRegistry;
+
 /**
  * Handler class for Blueprint-related MCP commands
  */
@@ -11,8 +13,8 @@ class FEpicUnrealMCPBlueprintCommands
 public:
     	FEpicUnrealMCPBlueprintCommands();
 
-    // Handle blueprint commands
-    TSharedPtr<FJsonObject> HandleCommand(const FString& CommandType, const TSharedPtr<FJsonObject>& Params);
+    // Register blueprint commands with the bridge's dispatch table
+    void RegisterCommands(FEpicUnrealMCPCommandRegistry& Registry);
 
 private:
     // Specific blueprint command handlers (only used functions)
@@ -5,6 +5,8 @@
 #include "CoreMinimal.h"
 #include "Dom/JsonObject.h"
 
+class FEpicUnrealMCPCommandRegistry;
+
 class FEpicUnrealMCPBlueprintGraphCommands
 {
 public:
@@ -12,12 +14,10 @@ public:
     ~FEpicUnrealMCPBlueprintGraphCommands();
 
     /**
-     * Main command handler for Blueprint Graph operations
-     * @param CommandType The type of command to execute
-     * @param Params JSON parameters for the command
-     * @return JSON response object
+     * Registers the Blueprint Graph commands with the bridge's dispatch table
+     * @param Registry Table the handlers are added to, bound to this instance
      */
-    TSharedPtr<FJsonObject> HandleCommand(const FString& CommandType, const TSharedPtr<FJsonObject>& Params);
+    void RegisterCommands(FEpicUnrealMCPCommandRegistry& Registry);
 
 private:
     // Add node to Blueprint graph
@@ -0,0 +1,48 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Json.h"
+
+DECLARE_DELEGATE_RetVal_OneParam(TSharedPtr<FJsonObject>, FMCPCommandHandler, const TSharedPtr<FJsonObject>& /*Params*/);
+
+enum class EMCPCommandFlags : uint8
+{
+    None = 0,
+    // Touches UObjects, runs inside the game thread task
+    GameThread = 1 << 0,
+    // Doesn't modify the editor state
+    ReadOnly = 1 << 1,
+    // May be used inside a batch command
+    Batchable = 1 << 2,
+};
+ENUM_CLASS_FLAGS(EMCPCommandFlags)
+
+struct FMCPCommandInfo
+{
+    FName Name;
+    FString Category;
+    EMCPCommandFlags Flags = EMCPCommandFlags::None;
+    FMCPCommandHandler Handler;
+
+    bool HasAnyFlags(EMCPCommandFlags InFlags) const { return EnumHasAnyFlags(Flags, InFlags); }
+};
+
+/**
+ * Name to handler table for all MCP commands
+ * Handler classes register their commands once at startup, dispatch is a single FName hash lookup.
+ * The table is not modified after startup so it can be read from any thread.
+ */
+class UNREALMCP_API FEpicUnrealMCPCommandRegistry
+{
+public:
+    void Register(const TCHAR* Name, const FString& Category, EMCPCommandFlags Flags, FMCPCommandHandler Handler);
+
+    /** Null for unknown commands, never adds the name to the FName table */
+    const FMCPCommandInfo* Find(const FString& CommandType) const;
+
+    /** Result of the list_commands command */
+    TSharedPtr<FJsonObject> DescribeCommands() const;
+
+private:
+    TMap<FName, FMCPCommandInfo> Commands;
+};
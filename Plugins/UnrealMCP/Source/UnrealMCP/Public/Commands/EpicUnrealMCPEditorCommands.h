@@ -3,6 +3,8 @@
 #include "CoreMinimal.h"
 #include "Json.h"
 
+class FEpicUnrealMCPCommandRegistry;
+
 /**
  * Handler class for Editor-related MCP commands
  * Handles viewport control, actor manipulation, and level management
@@ -12,8 +14,8 @@ class UNREALMCP_API FEpicUnrealMCPEditorCommands
 public:
     	FEpicUnrealMCPEditorCommands();
 
-    // Handle editor commands
-    TSharedPtr<FJsonObject> HandleCommand(const FString& CommandType, const TSharedPtr<FJsonObject>& Params);
+    // Register editor commands with the bridge's dispatch table
+    void RegisterCommands(FEpicUnrealMCPCommandRegistry& Registry);
 
 private:
     // Actor manipulation commands
@@ -22,7 +24,4 @@ private:
     TSharedPtr<FJsonObject> HandleSpawnActor(const TSharedPtr<FJsonObject>& Params);
     TSharedPtr<FJsonObject> HandleDeleteActor(const TSharedPtr<FJsonObject>& Params);
     TSharedPtr<FJsonObject> HandleSetActorTransform(const TSharedPtr<FJsonObject>& Params);
-
-    // Blueprint actor spawning
-    TSharedPtr<FJsonObject> HandleSpawnBlueprintActor(const TSharedPtr<FJsonObject>& Params);
 }; 
\ No newline at end of file
@@ -11,9 +11,22 @@
 #include "Commands/EpicUnrealMCPEditorCommands.h"
 #include "Commands/EpicUnrealMCPBlueprintCommands.h"
 #include "Commands/EpicUnrealMCPBlueprintGraphCommands.h"
+#include "Commands/EpicUnrealMCPCommandRegistry.h"
 #include "EpicUnrealMCPBridge.generated.h"
 
 class FMCPServerRunnable;
+class FMCPEditorSnapshot;
+
+/**
+ * A single command received from a client
+ * RequestId is optional and echoed back in the response so clients can pipeline requests
+ */
+struct FMCPCommandRequest
+{
+	FString CommandType;
+	TSharedPtr<FJsonObject> Params;
+	TSharedPtr<FJsonValue> RequestId;
+};
 
 /**
  * Editor subsystem for MCP Bridge
@@ -42,7 +55,33 @@ public:
 	// Command execution
 	FString ExecuteCommand(const FString& CommandType, const TSharedPtr<FJsonObject>& Params);
 
+	/**
+	 * Runs all requests in order inside a single game thread task.
+	 * Leading requests that can be answered from the editor snapshot or need no game thread run on the calling thread first.
+	 * OnResponse is called with each serialized response as soon as it is ready,
+	 * a batch command reports every sub-command before its own summary.
+	 */
+	TFuture<void> ExecuteCommandsAsync(TArray<FMCPCommandRequest> Requests, TFunction<void(FString&&)> OnResponse);
+
 private:
+	// Game thread commands must be run on the game thread, returns the response object with status and result or error
+	TSharedPtr<FJsonObject> RunCommand(const FString& CommandType, const TSharedPtr<FJsonObject>& Params);
+	bool RequiresGameThread(const FString& CommandType) const;
+
+	// Any thread. False when the command has to go through the game thread
+	bool TryRunOffGameThread(const FString& CommandType, const TSharedPtr<FJsonObject>& Params, TSharedPtr<FJsonObject>& OutResponse);
+
+	// Commands handled by the bridge itself
+	TSharedPtr<FJsonObject> HandlePing(const TSharedPtr<FJsonObject>& Params);
+	TSharedPtr<FJsonObject> HandleListCommands(const TSharedPtr<FJsonObject>& Params);
+	TSharedPtr<FJsonObject> HandleNestedBatch(const TSharedPtr<FJsonObject>& Params);
+	void ExecuteBatchOnGameThread(const FMCPCommandRequest& Request, const TFunction<void(FString&&)>& OnResponse);
+
+	static TSharedPtr<FJsonObject> MakeCommandResponse(const TSharedPtr<FJsonObject>& ResultJson);
+	static TSharedPtr<FJsonObject> MakeErrorResponse(const FString& ErrorMessage);
+	static FString SerializeResponse(const TSharedPtr<FJsonObject>& ResponseJson, const TSharedPtr<FJsonValue>& RequestId);
+
+
 	// Server state
 	bool bIsRunning;
 	TSharedPtr<FSocket> ListenerSocket;
@@ -53,6 +92,12 @@ private:
 	FIPv4Address ServerAddress;
 	uint16 Port;
 
+	// Name to handler table, filled in the constructor and read-only afterwards
+	FEpicUnrealMCPCommandRegistry CommandRegistry;
+
+	// Level and Blueprint copies that read-only commands are answered from off the game thread
+	TSharedPtr<FMCPEditorSnapshot> EditorSnapshot;
+
 	// Command handler instances
 	TSharedPtr<FEpicUnrealMCPEditorCommands> EditorCommands;
 	TSharedPtr<FEpicUnrealMCPBlueprintCommands> BlueprintCommands;
@@ -0,0 +1,125 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HAL/Runnable.h"
+#include "HAL/CriticalSection.h"
+#include "Containers/Queue.h"
+#include "Sockets.h"
+#include "EpicUnrealMCPBridge.h"
+#include "MCPMessageFraming.h"
+#include <atomic>
+
+class FRunnableThread;
+class FEvent;
+
+/**
+ * Where the game thread delivers a connection's responses.
+ * Shared with the command callbacks so a group still running when the connection shuts down has somewhere to write.
+ */
+struct FMCPResponseChannel
+{
+	FMCPResponseChannel();
+	~FMCPResponseChannel();
+
+	void Push(FString&& Response);
+
+	TQueue<FString, EQueueMode::Mpsc> Responses;
+	FEvent* Event;
+};
+
+/**
+ * One connected tooling client, served on its own thread.
+ * The thread sleeps in FSocket::Wait until the socket is readable, so requests
+ * are picked up as soon as they arrive and clients never wait on each other's I/O.
+ * Every message already received is sent to the game thread together, responses
+ * are streamed back in order while the commands are still running.
+ */
+class FMCPClientConnection : public FRunnable
+{
+public:
+	FMCPClientConnection(UEpicUnrealMCPBridge* InBridge, TSharedPtr<FSocket> InSocket, int32 InClientId);
+	virtual ~FMCPClientConnection();
+
+	bool Start();
+
+	/** Signals the thread and waits for it to exit, never for commands still running on the game thread */
+	void Shutdown();
+
+	bool IsFinished() const { return bFinished; }
+
+	int32 GetClientId() const { return ClientId; }
+
+	// FRunnable interface
+	virtual uint32 Run() override;
+	virtual void Stop() override;
+
+private:
+	/** Drains everything the socket has buffered, false once the client is gone */
+	bool ReceiveAvailable();
+
+	/** Runs every complete message in the read buffer in order, false when the stream can't be framed */
+	bool ProcessReadBuffer();
+
+	/** Adds the message to PendingRequests, or queues an error response when it isn't a valid command */
+	void ParseMessage(TConstArrayView<uint8> Message);
+
+	/** Executes PendingRequests in one game thread task, streaming their responses as they complete */
+	void RunPendingRequests();
+
+	void DrainCompletedResponses();
+
+	void QueueResponse(const FString& Response);
+
+	/** Sends the write queue, waiting for writability when the socket buffer is full */
+	bool FlushWriteQueue();
+
+	void RecordLatencySamples();
+
+	UEpicUnrealMCPBridge* Bridge;
+	TSharedPtr<FSocket> Socket;
+	FRunnableThread* Thread;
+	int32 ClientId;
+
+	FMCPByteRingBuffer ReadBuffer;
+	FMCPMessageFramer Framer;
+
+	/** Only used for messages that wrap around the end of the ring buffer */
+	TArray<uint8> FrameScratch;
+
+	TArray<FMCPCommandRequest> PendingRequests;
+
+	/** Filled on the game thread while a group of requests runs */
+	TSharedRef<FMCPResponseChannel, ESPMode::ThreadSafe> CompletedResponses;
+
+	TArray<uint8> WriteQueue;
+	int32 WriteOffset;
+	bool bConnectionLost;
+
+	/** When each queued response's message was complete, measured until the response is fully sent */
+	TArray<double> PendingRequestTimes;
+
+	std::atomic<bool> bRunning;
+	std::atomic<bool> bFinished;
+};
+
+/**
+ * Request latency samples shared by all connections, printed with MCP.LogLatency
+ */
+class FMCPLatencyStats
+{
+public:
+	static FMCPLatencyStats& Get();
+
+	void AddSample(double Milliseconds);
+	void Log();
+	void Reset();
+
+	std::atomic<int32> NumClients{0};
+
+private:
+	static constexpr int32 MaxSamples = 4096;
+
+	FCriticalSection Lock;
+	TArray<double> Samples;
+	int32 NextSample = 0;
+};
@@ -0,0 +1,133 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Dom/JsonObject.h"
+#include "Containers/Ticker.h"
+#include "UObject/WeakObjectPtr.h"
+
+class AActor;
+class UBlueprint;
+class UEdGraph;
+struct FBPVariableDescription;
+struct FPropertyChangedEvent;
+
+struct FMCPPinSnapshot
+{
+	FString Name;
+	FString Category;
+	bool bIsInput = false;
+
+	/** Owning node and pin name of every linked pin */
+	TArray<TPair<FString, FString>> LinkedTo;
+};
+
+struct FMCPNodeSnapshot
+{
+	FString Name;
+	FString ClassName;
+	FString Title;
+	int32 PosX = 0;
+	int32 PosY = 0;
+	bool bCanRename = false;
+	TArray<FMCPPinSnapshot> Pins;
+};
+
+/**
+ * Copy of an event or function graph, enough to answer analyze_blueprint_graph without the UEdGraph
+ */
+struct FMCPGraphSnapshot
+{
+	FString Name;
+	FString ClassName;
+	TArray<FMCPNodeSnapshot> Nodes;
+
+	static FMCPGraphSnapshot Capture(const UEdGraph* Graph);
+
+	TSharedPtr<FJsonObject> ToJson(bool bIncludeNodeDetails, bool bIncludePinConnections) const;
+};
+
+struct FMCPBlueprintSnapshot
+{
+	/** Event graphs first, then function graphs, the order graphs are looked up in */
+	TArray<FMCPGraphSnapshot> Graphs;
+
+	TArray<FString> VariableNames;
+	TArray<TSharedPtr<FJsonObject>> Variables;
+
+	static TSharedPtr<FJsonObject> VariableToJson(const FBPVariableDescription& Variable);
+};
+
+struct FMCPLevelSnapshot
+{
+	TArray<FString> ActorNames;
+	TArray<TSharedPtr<FJsonValue>> Actors;
+};
+
+/**
+ * Immutable copies of the level actors and of Blueprints that clients asked about.
+ * They are captured on the game thread from a core ticker after change notifications
+ * mark them dirty, and read from any thread so read-only commands skip the game thread.
+ * Anything not covered, or captured while PIE is running, falls back to the game thread.
+ */
+class FMCPEditorSnapshot
+{
+public:
+	void Initialize();
+	void Deinitialize();
+
+	/** Any thread. False when the command has to run on the game thread instead */
+	bool TryAnswer(const FString& CommandType, const TSharedPtr<FJsonObject>& Params, TSharedPtr<FJsonObject>& OutResult);
+
+	/** Game thread, after a command that may have changed anything */
+	void InvalidateAll();
+
+private:
+	bool Tick(float DeltaTime);
+
+	void CaptureLevel();
+	void CaptureRequestedBlueprints();
+
+	void InvalidateLevel();
+	void InvalidateBlueprint(const UBlueprint* Blueprint);
+
+	void OnActorChanged(AActor* Actor);
+	void OnObjectModified(UObject* Object);
+	void OnObjectPropertyChanged(UObject* Object, FPropertyChangedEvent& PropertyChangedEvent);
+	void OnMapChange(uint32 MapChangeFlags);
+	void OnPIEChanged(bool bIsSimulating);
+
+	bool AnswerGetActorsInLevel(const TSharedPtr<FJsonObject>& Params, TSharedPtr<FJsonObject>& OutResult);
+	bool AnswerFindActorsByName(const TSharedPtr<FJsonObject>& Params, TSharedPtr<FJsonObject>& OutResult);
+	bool AnswerAnalyzeBlueprintGraph(const TSharedPtr<FJsonObject>& Params, TSharedPtr<FJsonObject>& OutResult);
+	bool AnswerGetBlueprintVariableDetails(const TSharedPtr<FJsonObject>& Params, TSharedPtr<FJsonObject>& OutResult);
+
+	/** Null when the path isn't captured yet, it is then requested for the next capture */
+	TSharedPtr<const FMCPBlueprintSnapshot, ESPMode::ThreadSafe> FindBlueprint(const FString& BlueprintPath);
+
+	typedef bool (FMCPEditorSnapshot::*FAnswerFunction)(const TSharedPtr<FJsonObject>&, TSharedPtr<FJsonObject>&);
+	TMap<FName, FAnswerFunction> AnswerFunctions;
+
+	// Guards the published snapshots and RequestedBlueprints
+	FRWLock Lock;
+	TSharedPtr<const FMCPLevelSnapshot, ESPMode::ThreadSafe> Level;
+	TMap<FString, TSharedPtr<const FMCPBlueprintSnapshot, ESPMode::ThreadSafe>> Blueprints;
+	TSet<FString> RequestedBlueprints;
+
+	// Game thread only
+	TMap<FString, TWeakObjectPtr<UBlueprint>> TrackedBlueprints;
+	bool bLevelDirty = true;
+	double LastLevelCaptureTime = 0.0;
+	double LastBlueprintCaptureTime = 0.0;
+
+	FTSTicker::FDelegateHandle TickerHandle;
+	FDelegateHandle ActorAddedHandle;
+	FDelegateHandle ActorDeletedHandle;
+	FDelegateHandle ActorMovedHandle;
+	FDelegateHandle ObjectModifiedHandle;
+	FDelegateHandle ObjectPropertyChangedHandle;
+	FDelegateHandle MapChangeHandle;
+	FDelegateHandle PostPIEStartedHandle;
+	FDelegateHandle EndPIEHandle;
+	FDelegateHandle PostUndoRedoHandle;
+	FDelegateHandle BlueprintCompiledHandle;
+};
@@ -0,0 +1,86 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * Growable byte ring buffer used as a connection's read buffer.
+ * Recv writes straight into the free space and frames are read in place,
+ * bytes are only copied when a frame wraps around the end of the storage.
+ */
+class FMCPByteRingBuffer
+{
+public:
+	explicit FMCPByteRingBuffer(int32 InitialCapacity = 65536);
+
+	int32 Num() const { return (int32)(Tail - Head); }
+
+	uint8 operator[](int32 Offset) const { return Data[(Head + Offset) & Mask]; }
+
+	/** Contiguous free space at the write position, the storage doubles when less than MinFree is left */
+	TArrayView<uint8> GetWriteSpace(int32 MinFree = 4096);
+	void CommitWrite(int32 Count);
+
+	/** Bytes [Offset, Offset + Count) from the read position, copied into Scratch only when the range wraps */
+	TConstArrayView<uint8> Peek(int32 Offset, int32 Count, TArray<uint8>& Scratch) const;
+
+	void Consume(int32 Count);
+
+private:
+	void Grow(int32 MinCapacity);
+
+	TArray<uint8> Data;
+	uint64 Mask;
+	uint64 Head;
+	uint64 Tail;
+};
+
+enum class EMCPFraming : uint8
+{
+	/** Nothing received yet, decided by the first byte */
+	Unknown,
+	/** Bare JSON objects, optionally newline separated. Boundaries are found by matching braces */
+	Json,
+	/** 4 byte big-endian payload size followed by the UTF-8 payload */
+	LengthPrefixed,
+};
+
+/**
+ * Splits a connection's byte stream into complete messages.
+ * Scanning is incremental, every byte is looked at once however many segments a message arrives in.
+ * Responses are framed the same way the client framed its requests.
+ */
+class FMCPMessageFramer
+{
+public:
+	/** Kept below 16 MiB so the high byte of a size prefix is zero, which is how length prefixed framing is detected */
+	static constexpr int32 MaxFrameSize = (1 << 24) - 1;
+
+	/** Finds the next complete frame at the start of Buffer, false when more bytes are needed or the stream is invalid */
+	bool NextFrame(const FMCPByteRingBuffer& Buffer, int32& OutFrameOffset, int32& OutFrameSize, int32& OutConsumed);
+
+	void AppendResponse(const FString& Response, TArray<uint8>& OutQueue) const;
+
+	bool HasError() const { return !Error.IsEmpty(); }
+	const FString& GetError() const { return Error; }
+
+	EMCPFraming GetFraming() const { return Framing; }
+
+private:
+	bool NextJsonFrame(const FMCPByteRingBuffer& Buffer, int32& OutFrameOffset, int32& OutFrameSize, int32& OutConsumed);
+	bool NextLengthPrefixedFrame(const FMCPByteRingBuffer& Buffer, int32& OutFrameOffset, int32& OutFrameSize, int32& OutConsumed);
+
+	void ResetScan();
+
+	EMCPFraming Framing = EMCPFraming::Unknown;
+	FString Error;
+
+	/** Set once the client separates messages with newlines, responses then end with one as well */
+	bool bNewlineDelimited = false;
+
+	// JSON scan state, offsets are relative to the buffer's read position
+	int32 ScanOffset = 0;
+	int32 FrameOffset = INDEX_NONE;
+	int32 Depth = 0;
+	bool bInString = false;
+	bool bEscaped = false;
+};
@@ -6,9 +6,11 @@
 #include "Interfaces/IPv4/IPv4Address.h"
 
 class UEpicUnrealMCPBridge;
+class FMCPClientConnection;
 
 /**
  * Runnable class for the MCP server thread
+ * Accepts clients as soon as they connect and hands each to its own FMCPClientConnection
  */
 class FMCPServerRunnable : public FRunnable
 {
@@ -23,12 +25,13 @@ public:
 	virtual void Exit() override;
 
 protected:
-	void HandleClientConnection(TSharedPtr<FSocket> ClientSocket);
-	void ProcessMessage(TSharedPtr<FSocket> Client, const FString& Message);
+	void AcceptPendingClients();
+	void RemoveFinishedClients();
 
 private:
 	UEpicUnrealMCPBridge* Bridge;
 	TSharedPtr<FSocket> ListenerSocket;
-	TSharedPtr<FSocket> ClientSocket;
+	TArray<TSharedPtr<FMCPClientConnection>> Clients;
+	int32 NextClientId;
 	bool bRunning;
 }; 
\ No newline at end of file
@@ -1,10 +1,8 @@
 ﻿#include "RogueAICharacter.h"
 
-#include "AIController.h"
-#include "RogueGameTypes.h"
 #include "SharedGameplayTags.h"
 #include "ActionSystem/RogueActionSystemComponent.h"
-#include "BehaviorTree/BlackboardComponent.h"
+#include "Core/RogueGameMode.h"
 
 
 ARogueAICharacter::ARogueAICharacter()
@@ -21,3 +19,22 @@ float ARogueAICharacter::TakeDamage(float DamageAmount, struct FDamageEvent cons
 
 	return ActualDamage;
 }
+
+void ARogueAICharacter::PostInitializeComponents()
+{
+	Super::PostInitializeComponents();
+
+	ActionSystemComponent->GetAttributeListener(SharedGameplayTags::Attribute_Health).AddUObject(
+		this, &ThisClass::OnHealthChanged);
+}
+
+void ARogueAICharacter::OnHealthChanged(FGameplayTag AttributeTag, float NewHealth, float OldHealth)
+{
+	if (NewHealth <= 0.0f && OldHealth > 0.0f)
+	{
+		if (ARogueGameMode* GameMode = GetWorld()->GetAuthGameMode<ARogueGameMode>())
+		{
+			GameMode->OnMinionKilled(this);
+		}
+	}
+}
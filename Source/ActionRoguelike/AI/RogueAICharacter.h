@@ -3,6 +3,7 @@
 #pragma once
 
 #include "CoreMinimal.h"
+#include "GameplayTagContainer.h"
 #include "GameFramework/Character.h"
 #include "RogueAICharacter.generated.h"
 
@@ -23,4 +24,9 @@ public:
 
 	virtual float TakeDamage(float DamageAmount, struct FDamageEvent const& DamageEvent,
 	                         class AController* EventInstigator, AActor* DamageCauser);
+
+	virtual void PostInitializeComponents() override;
+
+protected:
+	void OnHealthChanged(FGameplayTag AttributeTag, float NewHealth, float OldHealth);
 };
@@ -3,8 +3,8 @@
 
 #include "RogueAIController.h"
 
-#include "RogueGameTypes.h"
-#include "BehaviorTree/BlackboardComponent.h"
+#include "RogueAILODSubsystem.h"
+#include "RogueBlackboardKeys.h"
 #include "Kismet/GameplayStatics.h"
 
 ARogueAIController::ARogueAIController()
@@ -21,6 +21,20 @@ void ARogueAIController::BeginPlay()
 	APawn* PlayerPawn = UGameplayStatics::GetPlayerPawn(this, 0);
 	check(PlayerPawn);
 
-	GetBlackboardComponent()->SetValueAsObject(NAME_TargetActor, PlayerPawn);
-	GetBlackboardComponent()->SetValueAsFloat(NAME_HealPercent, 1.0f);
+	BlackboardKeys = FRogueBlackboardKeys::Get(GetBlackboardComponent()->GetBlackboardAsset());
+
+	RogueBlackboard::SetObject(GetBlackboardComponent(), BlackboardKeys.TargetActor, PlayerPawn);
+	RogueBlackboard::SetFloat(GetBlackboardComponent(), BlackboardKeys.HealthPercent, 1.0f);
+
+	GetWorld()->GetSubsystem<URogueAILODSubsystem>()->RegisterController(this);
+}
+
+void ARogueAIController::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	if (URogueAILODSubsystem* LODSubsystem = GetWorld()->GetSubsystem<URogueAILODSubsystem>())
+	{
+		LODSubsystem->UnregisterController(this);
+	}
+
+	Super::EndPlay(EndPlayReason);
 }
@@ -4,6 +4,7 @@
 
 #include "CoreMinimal.h"
 #include "Runtime/AIModule/Classes/AIController.h"
+#include "RogueBlackboardKeys.h"
 #include "RogueAIController.generated.h"
 
 class UBehaviorTree;
@@ -16,9 +17,19 @@ class ACTIONROGUELIKE_API ARogueAIController : public AAIController
 public:
 	ARogueAIController();
 
+	/* Resolved keys of the running blackboard, valid after BeginPlay */
+	const FRogueBlackboardKeys& GetBlackboardKeys() const
+	{
+		return BlackboardKeys;
+	}
+
 protected:
 	UPROPERTY(EditDefaultsOnly, Category="AI")
 	TObjectPtr<UBehaviorTree> BehaviorTree;
 
+	FRogueBlackboardKeys BlackboardKeys;
+
 	virtual void BeginPlay() override;
+
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
 };
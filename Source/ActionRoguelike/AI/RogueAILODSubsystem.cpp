@@ -0,0 +1,180 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "RogueAILODSubsystem.h"
+
+#include "ActionRoguelike.h"
+#include "AIController.h"
+#include "GameFramework/Character.h"
+#include "GameFramework/CharacterMovementComponent.h"
+#include "Navigation/PathFollowingComponent.h"
+
+TAutoConsoleVariable<bool> CVarAILODEnabled(TEXT("game.ai.LOD"), true,
+                                            TEXT("Throttle AI tick rates by distance and visibility to the player. (0 = Off, 1 = enabled)"),
+                                            ECVF_Cheat);
+
+TAutoConsoleVariable<float> CVarAILODBudgetMs(TEXT("game.ai.LODBudgetMs"), 0.1f,
+                                              TEXT("Milliseconds per frame spent re-evaluating AI LOD, remaining controllers continue next frame."),
+                                              ECVF_Cheat);
+
+DECLARE_CYCLE_STAT(TEXT("AI LOD Evaluation"), STAT_AILODEvaluation, STATGROUP_ActionRoguelike);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("AI LOD High"), STAT_AILODHigh, STATGROUP_ActionRoguelike);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("AI LOD Medium"), STAT_AILODMedium, STATGROUP_ActionRoguelike);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("AI LOD Low"), STAT_AILODLow, STATGROUP_ActionRoguelike);
+DECLARE_DWORD_COUNTER_STAT(TEXT("AI LOD Evaluated"), STAT_AILODEvaluated, STATGROUP_ActionRoguelike);
+
+
+void URogueAILODSubsystem::RegisterController(AAIController* InController)
+{
+	FRogueAILODEntry NewEntry;
+	NewEntry.Controller = InController;
+	NewEntry.ControllerKey = InController;
+	Entries.Add(NewEntry);
+	LODByController.Add(InController, ERogueAILOD::High);
+
+	NumPerLOD[(int32)ERogueAILOD::High]++;
+}
+
+void URogueAILODSubsystem::UnregisterController(AAIController* InController)
+{
+	int32 Index = Entries.IndexOfByPredicate([InController](const FRogueAILODEntry& Entry)
+	{
+		return Entry.Controller == InController;
+	});
+
+	if (Index != INDEX_NONE)
+	{
+		NumPerLOD[(int32)Entries[Index].LOD]--;
+		LODByController.Remove(Entries[Index].ControllerKey);
+		Entries.RemoveAtSwap(Index);
+	}
+}
+
+float URogueAILODSubsystem::GetBehaviorTickInterval(const AAIController* InController) const
+{
+	const ERogueAILOD* LOD = LODByController.Find(InController);
+	return LOD ? GetTickInterval(*LOD) : 0.0f;
+}
+
+void URogueAILODSubsystem::Tick(float DeltaTime)
+{
+	SCOPE_CYCLE_COUNTER(STAT_AILODEvaluation);
+
+	APlayerController* PC = GetWorld()->GetFirstPlayerController();
+	if (PC == nullptr || PC->PlayerCameraManager == nullptr)
+	{
+		return;
+	}
+
+	FVector ViewLocation = PC->PlayerCameraManager->GetCameraLocation();
+
+	double EndTime = FPlatformTime::Seconds() + CVarAILODBudgetMs.GetValueOnGameThread() / 1000.0;
+
+	int32 NumEvaluated = 0;
+	int32 NumToEvaluate = Entries.Num();
+	while (NumEvaluated < NumToEvaluate && Entries.Num() > 0)
+	{
+		// Always make progress on at least one controller
+		if (NumEvaluated > 0 && FPlatformTime::Seconds() > EndTime)
+		{
+			break;
+		}
+		NumEvaluated++;
+
+		if (NextEntryIndex >= Entries.Num())
+		{
+			NextEntryIndex = 0;
+		}
+
+		FRogueAILODEntry& Entry = Entries[NextEntryIndex];
+		AAIController* Controller = Entry.Controller.Get();
+		if (Controller == nullptr)
+		{
+			NumPerLOD[(int32)Entry.LOD]--;
+			LODByController.Remove(Entry.ControllerKey);
+			Entries.RemoveAtSwap(NextEntryIndex);
+			continue;
+		}
+
+		ERogueAILOD NewLOD = CalculateLOD(Controller, ViewLocation);
+		if (NewLOD != Entry.LOD)
+		{
+			NumPerLOD[(int32)Entry.LOD]--;
+			NumPerLOD[(int32)NewLOD]++;
+			Entry.LOD = NewLOD;
+			LODByController.Add(Entry.ControllerKey, NewLOD);
+
+			ApplyLOD(Controller, NewLOD);
+		}
+
+		NextEntryIndex++;
+	}
+
+	INC_DWORD_STAT_BY(STAT_AILODEvaluated, NumEvaluated);
+	SET_DWORD_STAT(STAT_AILODHigh, NumPerLOD[(int32)ERogueAILOD::High]);
+	SET_DWORD_STAT(STAT_AILODMedium, NumPerLOD[(int32)ERogueAILOD::Medium]);
+	SET_DWORD_STAT(STAT_AILODLow, NumPerLOD[(int32)ERogueAILOD::Low]);
+}
+
+ERogueAILOD URogueAILODSubsystem::CalculateLOD(const AAIController* InController, const FVector& ViewLocation) const
+{
+	APawn* Pawn = InController->GetPawn();
+	if (Pawn == nullptr || !CVarAILODEnabled.GetValueOnGameThread())
+	{
+		return ERogueAILOD::High;
+	}
+
+	double DistanceSquared = FVector::DistSquared(Pawn->GetActorLocation(), ViewLocation);
+	if (DistanceSquared < FMath::Square(HighLODDistance))
+	{
+		return ERogueAILOD::High;
+	}
+
+	// Anything on screen keeps at least medium, throttled movement is noticeable up close
+	if (DistanceSquared < FMath::Square(MediumLODDistance) || Pawn->WasRecentlyRendered(0.2f))
+	{
+		return ERogueAILOD::Medium;
+	}
+
+	return ERogueAILOD::Low;
+}
+
+void URogueAILODSubsystem::ApplyLOD(AAIController* InController, ERogueAILOD InLOD) const
+{
+	float TickInterval = GetTickInterval(InLOD);
+
+	InController->SetActorTickInterval(TickInterval);
+
+	if (UPathFollowingComponent* PathFollowingComp = InController->GetPathFollowingComponent())
+	{
+		PathFollowingComp->SetComponentTickInterval(TickInterval);
+	}
+
+	if (ACharacter* Character = Cast<ACharacter>(InController->GetPawn()))
+	{
+		Character->GetCharacterMovement()->SetComponentTickInterval(TickInterval);
+	}
+}
+
+float URogueAILODSubsystem::GetTickInterval(ERogueAILOD InLOD) const
+{
+	switch (InLOD)
+	{
+	case ERogueAILOD::Medium:
+		return MediumLODTickInterval;
+	case ERogueAILOD::Low:
+		return LowLODTickInterval;
+	default:
+		return 0.0f;
+	}
+}
+
+TStatId URogueAILODSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(URogueAILODSubsystem, STATGROUP_Tickables);
+}
+
+bool URogueAILODSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
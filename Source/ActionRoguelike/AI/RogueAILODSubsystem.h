@@ -0,0 +1,83 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "UObject/ObjectKey.h"
+#include "RogueAILODSubsystem.generated.h"
+
+class AAIController;
+
+UENUM()
+enum class ERogueAILOD : uint8
+{
+	High,
+	Medium,
+	Low,
+	Num UMETA(Hidden)
+};
+
+struct FRogueAILODEntry
+{
+	TWeakObjectPtr<AAIController> Controller;
+
+	/* Still valid for removing the LOD lookup once Controller is gone */
+	TObjectKey<AAIController> ControllerKey;
+
+	ERogueAILOD LOD = ERogueAILOD::High;
+};
+
+/* Buckets AI controllers by their significance to the local player and throttles the tick rate of
+ * their path following and movement to match. The behavior tree reschedules its own tick every frame,
+ * Rogue services and tasks read GetBehaviorTickInterval instead so the tree sleeps longer. Re-evaluation is spread over frames under a time budget */
+UCLASS(Config=Game)
+class ACTIONROGUELIKE_API URogueAILODSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	void RegisterController(AAIController* InController);
+
+	void UnregisterController(AAIController* InController);
+
+	/* Minimum time between service and task ticks of the controller's behavior tree, 0 at full rate */
+	float GetBehaviorTickInterval(const AAIController* InController) const;
+
+	virtual void Tick(float DeltaTime) override;
+
+	virtual TStatId GetStatId() const override;
+
+protected:
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+	ERogueAILOD CalculateLOD(const AAIController* InController, const FVector& ViewLocation) const;
+
+	void ApplyLOD(AAIController* InController, ERogueAILOD InLOD) const;
+
+	float GetTickInterval(ERogueAILOD InLOD) const;
+
+	/* Pawns within this distance always run at full rate */
+	UPROPERTY(Config)
+	float HighLODDistance = 2000.0f;
+
+	/* Pawns beyond this distance drop to the low LOD, unless rendered recently */
+	UPROPERTY(Config)
+	float MediumLODDistance = 5000.0f;
+
+	UPROPERTY(Config)
+	float MediumLODTickInterval = 0.1f;
+
+	UPROPERTY(Config)
+	float LowLODTickInterval = 0.5f;
+
+	TArray<FRogueAILODEntry> Entries;
+
+	/* Current LOD by controller for lookups from behavior tree nodes, kept in sync with Entries */
+	TMap<TObjectKey<AAIController>, ERogueAILOD> LODByController;
+
+	/* Round robin cursor into Entries, continues where the previous frame ran out of budget */
+	int32 NextEntryIndex = 0;
+
+	int32 NumPerLOD[(int32)ERogueAILOD::Num] = {};
+};
@@ -0,0 +1,182 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "RogueAIPerceptionSubsystem.h"
+
+#include "ActionRoguelike.h"
+#include "AIController.h"
+#include "RogueBlackboardKeys.h"
+
+TAutoConsoleVariable<int32> CVarLineOfSightTraceBudget(TEXT("game.ai.LineOfSightTraceBudget"), 32,
+                                                       TEXT("Max number of AI line of sight traces issued per frame, remaining requests wait for the next frame."),
+                                                       ECVF_Cheat);
+
+DECLARE_CYCLE_STAT(TEXT("AI Perception Tick"), STAT_AIPerceptionTick, STATGROUP_ActionRoguelike);
+DECLARE_DWORD_COUNTER_STAT(TEXT("AI Range Checks"), STAT_AIRangeChecks, STATGROUP_ActionRoguelike);
+DECLARE_DWORD_COUNTER_STAT(TEXT("AI Line Of Sight Traces"), STAT_AILineOfSightTraces, STATGROUP_ActionRoguelike);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("AI Pending Range Checks"), STAT_AIPendingRangeChecks, STATGROUP_ActionRoguelike);
+
+
+void URogueAIPerceptionSubsystem::RequestRangeCheck(AAIController* Querier, UBlackboardComponent* Blackboard,
+                                                    FBlackboard::FKey WithinRangeKey, AActor* TargetActor,
+                                                    float MaxRange)
+{
+	FRogueRangeCheckRequest Request;
+	Request.Querier = Querier;
+	Request.Blackboard = Blackboard;
+	Request.TargetActor = TargetActor;
+	Request.WithinRangeKey = WithinRangeKey;
+	Request.MaxRange = MaxRange;
+
+	if (const int32* ExistingIndex = PendingIndexByQuerier.Find(Querier))
+	{
+		PendingRequests[*ExistingIndex] = Request;
+		return;
+	}
+
+	PendingIndexByQuerier.Add(Querier, PendingRequests.Add(Request));
+}
+
+void URogueAIPerceptionSubsystem::Tick(float DeltaTime)
+{
+	SCOPE_CYCLE_COUNTER(STAT_AIPerceptionTick);
+
+	ResolveInFlightBatches();
+	IssuePendingRequests();
+
+	SET_DWORD_STAT(STAT_AIPendingRangeChecks, PendingRequests.Num());
+}
+
+void URogueAIPerceptionSubsystem::ResolveInFlightBatches()
+{
+	for (int32 Index = InFlightBatches.Num() - 1; Index >= 0; Index--)
+	{
+		FRogueLineOfSightBatch& Batch = InFlightBatches[Index];
+
+		FTraceDatum TraceDatum;
+		if (!GetWorld()->QueryTraceData(Batch.TraceHandle, TraceDatum))
+		{
+			// Results are kept for a single frame only, ask again in case they were missed
+			if (!GetWorld()->IsTraceHandleValid(Batch.TraceHandle, false))
+			{
+				for (const FRogueRangeCheckRequest& Request : Batch.Requests)
+				{
+					RequestRangeCheck(Request.Querier.Get(), Request.Blackboard.Get(), Request.WithinRangeKey,
+					                  Request.TargetActor.Get(), Request.MaxRange);
+				}
+				InFlightBatches.RemoveAtSwap(Index);
+			}
+			continue;
+		}
+
+		bool bHasLOS = !(TraceDatum.OutHits.Num() > 0 && TraceDatum.OutHits[0].bBlockingHit);
+		for (const FRogueRangeCheckRequest& Request : Batch.Requests)
+		{
+			WriteResult(Request, bHasLOS);
+		}
+
+		InFlightBatches.RemoveAtSwap(Index);
+	}
+}
+
+void URogueAIPerceptionSubsystem::IssuePendingRequests()
+{
+	if (PendingRequests.IsEmpty())
+	{
+		return;
+	}
+
+	// Group in request order so nothing starves when the budget runs out
+	TArray<FRogueLineOfSightBatch> Batches;
+	TMap<TPair<TObjectKey<AActor>, FIntVector>, int32> BatchIndexByTargetCell;
+
+	for (const FRogueRangeCheckRequest& Request : PendingRequests)
+	{
+		AAIController* Querier = Request.Querier.Get();
+		AActor* TargetActor = Request.TargetActor.Get();
+		APawn* OwningPawn = Querier ? Querier->GetPawn() : nullptr;
+		if (OwningPawn == nullptr || TargetActor == nullptr || !Request.Blackboard.IsValid())
+		{
+			continue;
+		}
+
+		INC_DWORD_STAT(STAT_AIRangeChecks);
+
+		float DistanceTo = FVector::Dist(TargetActor->GetActorLocation(), OwningPawn->GetActorLocation());
+		if (DistanceTo >= Request.MaxRange)
+		{
+			// Out of range fails regardless of line of sight, no trace required
+			WriteResult(Request, false);
+			continue;
+		}
+
+		TPair<TObjectKey<AActor>, FIntVector> BatchKey(TargetActor, ToCell(OwningPawn->GetActorLocation()));
+		int32& BatchIndex = BatchIndexByTargetCell.FindOrAdd(BatchKey, INDEX_NONE);
+		if (BatchIndex == INDEX_NONE)
+		{
+			BatchIndex = Batches.AddDefaulted();
+		}
+		Batches[BatchIndex].Requests.Add(Request);
+	}
+
+	PendingRequests.Reset();
+	PendingIndexByQuerier.Reset();
+
+	int32 TraceBudget = CVarLineOfSightTraceBudget.GetValueOnGameThread();
+
+	for (FRogueLineOfSightBatch& Batch : Batches)
+	{
+		if (TraceBudget <= 0)
+		{
+			for (const FRogueRangeCheckRequest& Request : Batch.Requests)
+			{
+				PendingIndexByQuerier.Add(Request.Querier.Get(), PendingRequests.Add(Request));
+			}
+			continue;
+		}
+		TraceBudget--;
+
+		// Same trace as AController::LineOfSightTo, from the eyes of the first querier to the target location
+		AAIController* Querier = Batch.Requests[0].Querier.Get();
+		AActor* TargetActor = Batch.Requests[0].TargetActor.Get();
+
+		FVector ViewLocation;
+		FRotator ViewRotation;
+		Querier->GetActorEyesViewPoint(ViewLocation, ViewRotation);
+
+		FCollisionQueryParams QueryParams(SCENE_QUERY_STAT(AILineOfSight), true, Querier->GetPawn());
+		QueryParams.AddIgnoredActor(TargetActor);
+
+		Batch.TraceHandle = GetWorld()->AsyncLineTraceByChannel(EAsyncTraceType::Single, ViewLocation,
+		                                                       TargetActor->GetActorLocation(), ECC_Visibility,
+		                                                       QueryParams);
+		InFlightBatches.Add(MoveTemp(Batch));
+
+		INC_DWORD_STAT(STAT_AILineOfSightTraces);
+	}
+}
+
+void URogueAIPerceptionSubsystem::WriteResult(const FRogueRangeCheckRequest& Request, bool bWithinRange)
+{
+	if (UBlackboardComponent* Blackboard = Request.Blackboard.Get())
+	{
+		RogueBlackboard::SetBool(Blackboard, Request.WithinRangeKey, bWithinRange);
+	}
+}
+
+FIntVector URogueAIPerceptionSubsystem::ToCell(const FVector& Location) const
+{
+	return FIntVector(FMath::FloorToInt32(Location.X / CellSize),
+	                  FMath::FloorToInt32(Location.Y / CellSize),
+	                  FMath::FloorToInt32(Location.Z / CellSize));
+}
+
+TStatId URogueAIPerceptionSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(URogueAIPerceptionSubsystem, STATGROUP_Tickables);
+}
+
+bool URogueAIPerceptionSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
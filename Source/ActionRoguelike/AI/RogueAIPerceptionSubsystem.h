@@ -0,0 +1,73 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "WorldCollision.h"
+#include "BehaviorTree/BehaviorTreeTypes.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "RogueAIPerceptionSubsystem.generated.h"
+
+class AAIController;
+class UBlackboardComponent;
+
+struct FRogueRangeCheckRequest
+{
+	TWeakObjectPtr<AAIController> Querier;
+
+	TWeakObjectPtr<UBlackboardComponent> Blackboard;
+
+	TWeakObjectPtr<AActor> TargetActor;
+
+	/* Bool key receiving (within range && has line of sight) */
+	FBlackboard::FKey WithinRangeKey = FBlackboard::InvalidKey;
+
+	float MaxRange = 0.0f;
+};
+
+/* Queriers close to each other looking at the same target, they share a single visibility trace */
+struct FRogueLineOfSightBatch
+{
+	FTraceHandle TraceHandle;
+
+	TArray<FRogueRangeCheckRequest> Requests;
+};
+
+/* Shared range and line of sight checks for AI, requests are grouped per target and querier cell
+ * and resolved with async traces under a per frame budget */
+UCLASS()
+class ACTIONROGUELIKE_API URogueAIPerceptionSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	/* Result is written into the blackboard once the trace completes, a newer request from the same querier replaces a pending one */
+	void RequestRangeCheck(AAIController* Querier, UBlackboardComponent* Blackboard, FBlackboard::FKey WithinRangeKey,
+	                       AActor* TargetActor, float MaxRange);
+
+	virtual void Tick(float DeltaTime) override;
+
+	virtual TStatId GetStatId() const override;
+
+protected:
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+	/* Applies the traces issued on previous frames */
+	void ResolveInFlightBatches();
+
+	/* Range checks all pending requests and issues visibility traces for those within range */
+	void IssuePendingRequests();
+
+	static void WriteResult(const FRogueRangeCheckRequest& Request, bool bWithinRange);
+
+	FIntVector ToCell(const FVector& Location) const;
+
+	/* Queriers within the same cell share the trace of the first one */
+	float CellSize = 200.0f;
+
+	TArray<FRogueRangeCheckRequest> PendingRequests;
+
+	TMap<TObjectKey<AAIController>, int32> PendingIndexByQuerier;
+
+	TArray<FRogueLineOfSightBatch> InFlightBatches;
+};
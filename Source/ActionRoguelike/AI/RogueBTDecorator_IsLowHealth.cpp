@@ -4,22 +4,143 @@
 #include "RogueBTDecorator_IsLowHealth.h"
 
 #include "AIController.h"
+#include "SharedGameplayTags.h"
 #include "ActionSystem/RogueActionSystemComponent.h"
+#include "ActionSystem/RogueAttributeSet.h"
+#include "BehaviorTree/BehaviorTreeComponent.h"
 
-class URogueActionSystemComponent;
+
+URogueBTDecorator_IsLowHealth::URogueBTDecorator_IsLowHealth()
+{
+	NodeName = "Is Low Health";
+	bNotifyBecomeRelevant = true;
+}
 
 bool URogueBTDecorator_IsLowHealth::CalculateRawConditionValue(UBehaviorTreeComponent& OwnerComp,
                                                                uint8* NodeMemory) const
 {
+	FRogueIsLowHealthMemory* Memory = CastInstanceNodeMemory<FRogueIsLowHealthMemory>(NodeMemory);
+	if (Memory->ActionComp.IsValid())
+	{
+		return Memory->bIsLowHealth;
+	}
+
+	// Not bound yet, can happen when the tree is evaluated before the pawn was possessed
 	APawn* Pawn = OwnerComp.GetAIOwner()->GetPawn();
-	check(Pawn);
-	
-	URogueActionSystemComponent* ActionComp = Pawn->GetComponentByClass<URogueActionSystemComponent>();
+	URogueActionSystemComponent* ActionComp = Pawn ? Pawn->GetComponentByClass<URogueActionSystemComponent>() : nullptr;
 	if (ensure(ActionComp))
 	{
-		check(false);
-		return false;//(ActionComp->GetHealth() / ActionComp->GetHealthMax()) < LowHealthFraction;
+		return GetHealthFraction(ActionComp) < LowHealthFraction;
 	}
 	
 	return false;
 }
+
+void URogueBTDecorator_IsLowHealth::InitializeMemory(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory,
+                                                     EBTMemoryInit::Type InitType) const
+{
+	InitializeNodeMemory<FRogueIsLowHealthMemory>(NodeMemory, InitType);
+
+	BindHealthListeners(OwnerComp, CastInstanceNodeMemory<FRogueIsLowHealthMemory>(NodeMemory));
+}
+
+void URogueBTDecorator_IsLowHealth::CleanupMemory(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory,
+                                                  EBTMemoryClear::Type CleanupType) const
+{
+	UnbindHealthListeners(CastInstanceNodeMemory<FRogueIsLowHealthMemory>(NodeMemory));
+
+	CleanupNodeMemory<FRogueIsLowHealthMemory>(NodeMemory, CleanupType);
+}
+
+void URogueBTDecorator_IsLowHealth::OnBecomeRelevant(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory)
+{
+	Super::OnBecomeRelevant(OwnerComp, NodeMemory);
+
+	BindHealthListeners(OwnerComp, CastInstanceNodeMemory<FRogueIsLowHealthMemory>(NodeMemory));
+}
+
+uint16 URogueBTDecorator_IsLowHealth::GetInstanceMemorySize() const
+{
+	return sizeof(FRogueIsLowHealthMemory);
+}
+
+void URogueBTDecorator_IsLowHealth::BindHealthListeners(UBehaviorTreeComponent& OwnerComp,
+                                                        FRogueIsLowHealthMemory* Memory) const
+{
+	if (Memory->ActionComp.IsValid())
+	{
+		return;
+	}
+
+	APawn* Pawn = OwnerComp.GetAIOwner()->GetPawn();
+	URogueActionSystemComponent* ActionComp = Pawn ? Pawn->GetComponentByClass<URogueActionSystemComponent>() : nullptr;
+	if (ActionComp == nullptr)
+	{
+		return;
+	}
+
+	Memory->ActionComp = ActionComp;
+	Memory->HealthFraction = GetHealthFraction(ActionComp);
+	Memory->bIsLowHealth = Memory->HealthFraction < LowHealthFraction;
+
+	// Node is shared between all trees using the asset, the owner is passed along to find the right memory block
+	TWeakObjectPtr<UBehaviorTreeComponent> WeakOwnerComp(&OwnerComp);
+	Memory->HealthChangedHandle = ActionComp->GetAttributeListener(SharedGameplayTags::Attribute_Health)
+	                                        .AddUObject(this, &ThisClass::OnHealthAttributeChanged, WeakOwnerComp);
+	Memory->HealthMaxChangedHandle = ActionComp->GetAttributeListener(SharedGameplayTags::Attribute_HealthMax)
+	                                           .AddUObject(this, &ThisClass::OnHealthAttributeChanged, WeakOwnerComp);
+}
+
+void URogueBTDecorator_IsLowHealth::UnbindHealthListeners(FRogueIsLowHealthMemory* Memory) const
+{
+	if (URogueActionSystemComponent* ActionComp = Memory->ActionComp.Get())
+	{
+		ActionComp->GetAttributeListener(SharedGameplayTags::Attribute_Health).Remove(Memory->HealthChangedHandle);
+		ActionComp->GetAttributeListener(SharedGameplayTags::Attribute_HealthMax).Remove(Memory->HealthMaxChangedHandle);
+	}
+
+	Memory->ActionComp.Reset();
+}
+
+void URogueBTDecorator_IsLowHealth::OnHealthAttributeChanged(FGameplayTag AttributeTag, float NewValue, float OldValue,
+                                                             TWeakObjectPtr<UBehaviorTreeComponent> WeakOwnerComp) const
+{
+	UBehaviorTreeComponent* OwnerComp = WeakOwnerComp.Get();
+	if (OwnerComp == nullptr)
+	{
+		return;
+	}
+
+	uint8* NodeMemory = OwnerComp->GetNodeMemory(this, OwnerComp->FindInstanceContainingNode(this));
+	if (NodeMemory == nullptr)
+	{
+		return;
+	}
+
+	FRogueIsLowHealthMemory* Memory = CastInstanceNodeMemory<FRogueIsLowHealthMemory>(NodeMemory);
+	Memory->HealthFraction = GetHealthFraction(Memory->ActionComp.Get());
+
+	bool bIsLowHealth = Memory->HealthFraction < LowHealthFraction;
+	if (bIsLowHealth != Memory->bIsLowHealth)
+	{
+		Memory->bIsLowHealth = bIsLowHealth;
+		ConditionalFlowAbort(*OwnerComp, EBTDecoratorAbortRequest::ConditionResultChanged);
+	}
+}
+
+float URogueBTDecorator_IsLowHealth::GetHealthFraction(URogueActionSystemComponent* ActionComp)
+{
+	FRogueAttribute* Health = ActionComp ? ActionComp->GetAttribute(SharedGameplayTags::Attribute_Health) : nullptr;
+	FRogueAttribute* HealthMax = ActionComp ? ActionComp->GetAttribute(SharedGameplayTags::Attribute_HealthMax) : nullptr;
+	if (Health == nullptr || HealthMax == nullptr)
+	{
+		return 1.0f;
+	}
+
+	if (HealthMax->GetValue() <= 0.0f)
+	{
+		return 0.0f;
+	}
+
+	return Health->GetValue() / HealthMax->GetValue();
+}
@@ -3,11 +3,27 @@
 #pragma once
 
 #include "CoreMinimal.h"
+#include "GameplayTagContainer.h"
 #include "BehaviorTree/BTDecorator.h"
 #include "RogueBTDecorator_IsLowHealth.generated.h"
 
+class URogueActionSystemComponent;
+
+struct FRogueIsLowHealthMemory
+{
+	TWeakObjectPtr<URogueActionSystemComponent> ActionComp;
+
+	FDelegateHandle HealthChangedHandle;
+
+	FDelegateHandle HealthMaxChangedHandle;
+
+	float HealthFraction = 1.0f;
+
+	bool bIsLowHealth = false;
+};
+
 /**
- * 
+ * Listens to the health attributes of the controlled pawn, the condition is only re-evaluated when the threshold is crossed
  */
 UCLASS()
 class ACTIONROGUELIKE_API URogueBTDecorator_IsLowHealth : public UBTDecorator
@@ -19,6 +35,27 @@ protected:
 	UPROPERTY(EditAnywhere, Category = "AI", meta = (ClampMin="0.0", ClampMax="1.0"))
 	float LowHealthFraction = 0.3f;
 
+	/* Binds to the health listeners of the pawn, may be deferred to OnBecomeRelevant when the pawn is not possessed yet */
+	void BindHealthListeners(UBehaviorTreeComponent& OwnerComp, FRogueIsLowHealthMemory* Memory) const;
+
+	void UnbindHealthListeners(FRogueIsLowHealthMemory* Memory) const;
+
+	void OnHealthAttributeChanged(FGameplayTag AttributeTag, float NewValue, float OldValue,
+	                              TWeakObjectPtr<UBehaviorTreeComponent> WeakOwnerComp) const;
+
+	/* 1.0 when the attribute set has no Health or HealthMax, such pawns never count as low health */
+	static float GetHealthFraction(URogueActionSystemComponent* ActionComp);
+
 public:
+	URogueBTDecorator_IsLowHealth();
+
 	virtual bool CalculateRawConditionValue(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory) const override;
+
+	virtual void InitializeMemory(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory, EBTMemoryInit::Type InitType) const override;
+
+	virtual void CleanupMemory(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory, EBTMemoryClear::Type CleanupType) const override;
+
+	virtual void OnBecomeRelevant(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory) override;
+
+	virtual uint16 GetInstanceMemorySize() const override;
 };
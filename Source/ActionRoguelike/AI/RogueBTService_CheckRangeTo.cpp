@@ -1,31 +1,55 @@
 ﻿#include "RogueBTService_CheckRangeTo.h"
 #include "AIController.h"
-#include "BehaviorTree/BlackboardComponent.h"
+#include "ActionRoguelike.h"
+#include "RogueAILODSubsystem.h"
+#include "RogueAIPerceptionSubsystem.h"
+#include "RogueBlackboardKeys.h"
 
 TAutoConsoleVariable<bool> CVarLineOfSightToDebugDrawing(TEXT("game.ai.DebugDraw"), false,
                                                          TEXT(
 	                                                         "Enable ai LineOfSightTo debug rendering. (0 = Off, 1 = enabled)"),
                                                          ECVF_Cheat);
 
+DECLARE_DWORD_COUNTER_STAT(TEXT("CheckRangeTo Service Ticks"), STAT_CheckRangeToServiceTicks, STATGROUP_ActionRoguelike);
+
+void URogueBTService_CheckRangeTo::InitializeFromAsset(UBehaviorTree& Asset)
+{
+	Super::InitializeFromAsset(Asset);
+
+	if (UBlackboardData* BBAsset = GetBlackboardAsset())
+	{
+		TargetActorKey.ResolveSelectedKey(*BBAsset);
+		WithinRangeKey.ResolveSelectedKey(*BBAsset);
+	}
+}
+
 void URogueBTService_CheckRangeTo::TickNode(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory, float DeltaSeconds)
 {
 	Super::TickNode(OwnerComp, NodeMemory, DeltaSeconds);
 
+	INC_DWORD_STAT(STAT_CheckRangeToServiceTicks);
+
+	// The tree schedules its next tick from the earliest service or task due, stretching ours lets it sleep at low LOD
+	float LODTickInterval = GetWorld()->GetSubsystem<URogueAILODSubsystem>()->GetBehaviorTickInterval(OwnerComp.GetAIOwner());
+	if (LODTickInterval > Interval)
+	{
+		SetNextTickTime(NodeMemory, LODTickInterval);
+	}
+
 	UBlackboardComponent* BBComp = OwnerComp.GetBlackboardComponent();
 	check(BBComp);
 
-	AActor* TargetActor = Cast<AActor>(BBComp->GetValueAsObject(TargetActorKey.SelectedKeyName));
+	AActor* TargetActor = RogueBlackboard::GetActor(BBComp, TargetActorKey.GetSelectedKeyID());
 	if (TargetActor)
 	{
 		AAIController* Controller = OwnerComp.GetAIOwner();
 		APawn* OwningPawn = Controller->GetPawn();
 		check(OwningPawn);
 
-		float DistanceTo = FVector::Dist(TargetActor->GetActorLocation(), OwningPawn->GetActorLocation());
-		bool bWithinRange = DistanceTo < MaxAttackRange;
-		bool bHasLOS = Controller->LineOfSightTo(TargetActor);
-
-		BBComp->SetValueAsBool(WithinRangeKey.SelectedKeyName, (bWithinRange && bHasLOS));
+		// Resolved together with all other AI looking at the same target, the key updates a frame or two later
+		URogueAIPerceptionSubsystem* PerceptionSubsystem = GetWorld()->GetSubsystem<URogueAIPerceptionSubsystem>();
+		PerceptionSubsystem->RequestRangeCheck(Controller, BBComp, WithinRangeKey.GetSelectedKeyID(), TargetActor,
+		                                       MaxAttackRange);
 
 		bool bEnabledDebugDraw = CVarLineOfSightToDebugDrawing.GetValueOnGameThread();
 		if (bEnabledDebugDraw)
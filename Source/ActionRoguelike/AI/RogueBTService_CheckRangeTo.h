@@ -20,5 +20,7 @@ class ACTIONROGUELIKE_API URogueBTService_CheckRangeTo : public UBTService
 	UPROPERTY(EditAnywhere, Category="AI")
 	float MaxAttackRange = 500;
 
+	virtual void InitializeFromAsset(UBehaviorTree& Asset) override;
+
 	virtual void TickNode(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory, float DeltaSeconds) override;
 };
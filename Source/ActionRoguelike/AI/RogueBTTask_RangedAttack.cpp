@@ -2,9 +2,11 @@
 
 #include "AIController.h"
 #include "RogueGameTypes.h"
-#include "BehaviorTree/BlackboardComponent.h"
+#include "RogueBlackboardKeys.h"
 #include "GameFramework/Character.h"
+#include "Engine/AssetManager.h"
 #include "Projectiles/RogueProjectile.h"
+#include "Projectiles/RogueProjectileSubsystem.h"
 
 
 URogueBTTask_RangedAttack::URogueBTTask_RangedAttack()
@@ -12,32 +14,59 @@ URogueBTTask_RangedAttack::URogueBTTask_RangedAttack()
 	TargetActorKey.SelectedKeyName = NAME_TargetActor;
 }
 
-EBTNodeResult::Type URogueBTTask_RangedAttack::ExecuteTask(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory)
+void URogueBTTask_RangedAttack::InitializeFromAsset(UBehaviorTree& Asset)
 {
-	ACharacter* Pawn = Cast<ACharacter>(OwnerComp.GetAIOwner()->GetPawn());
-	check(Pawn);
+	Super::InitializeFromAsset(Asset);
 
-	FVector SpawnLocation = Pawn->GetMesh()->GetSocketLocation(MuzzleSocketName);
+	if (UBlackboardData* BBAsset = GetBlackboardAsset())
+	{
+		TargetActorKey.ResolveSelectedKey(*BBAsset);
+	}
 
-	AActor* TargetActor = Cast<AActor>(
-		OwnerComp.GetBlackboardComponent()->GetValueAsObject(TargetActorKey.SelectedKeyName));
-	if (!IsValid(TargetActor))
+	// Streams in while the tree starts up instead of on the first impact
+	if (ProjectileClass && !ProjectileAssetsHandle.IsValid())
 	{
-		return EBTNodeResult::Failed;
+		TArray<FSoftObjectPath> AssetPaths;
+		ProjectileClass->GetDefaultObject<ARogueProjectile>()->GetAssetsToPreload(AssetPaths);
+		AssetPaths.RemoveAll([](const FSoftObjectPath& AssetPath)
+		{
+			return AssetPath.IsNull();
+		});
+
+		if (!AssetPaths.IsEmpty())
+		{
+			ProjectileAssetsHandle = UAssetManager::GetStreamableManager().RequestAsyncLoad(MoveTemp(AssetPaths));
+		}
 	}
+}
 
-	FVector Direction = TargetActor->GetActorLocation() - SpawnLocation;
+bool URogueBTTask_RangedAttack::QueueShot(UBehaviorTreeComponent& OwnerComp) const
+{
+	ACharacter* Pawn = Cast<ACharacter>(OwnerComp.GetAIOwner()->GetPawn());
+	check(Pawn);
 
-	FRotator SpawnRotation = Direction.Rotation();
+	AActor* TargetActor = RogueBlackboard::GetActor(OwnerComp.GetBlackboardComponent(),
+	                                                TargetActorKey.GetSelectedKeyID());
+	if (!IsValid(TargetActor) || ProjectileClass == nullptr)
+	{
+		return false;
+	}
 
-	SpawnRotation.Pitch += FMath::FRandRange(0.0f, MaxBulletSpread);
-	SpawnRotation.Yaw += FMath::FRandRange(-MaxBulletSpread, MaxBulletSpread);
+	FRogueVolleyShot Shot;
+	Shot.Shooter = Pawn;
+	Shot.TargetActor = TargetActor;
+	Shot.ProjectileClass = ProjectileClass;
+	Shot.MuzzleSocketName = MuzzleSocketName;
+	Shot.MaxSpread = MaxBulletSpread;
 
-	FActorSpawnParameters SpawnParams;
-	SpawnParams.Instigator = Pawn;
-	SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+	// Fired at the end of the frame together with every other ranged attack
+	URogueProjectileSubsystem* ProjectileSubsystem = GetWorld()->GetSubsystem<URogueProjectileSubsystem>();
+	ProjectileSubsystem->QueueVolleyShot(Shot);
 
-	AActor* NewProj = GetWorld()->SpawnActor<AActor>(ProjectileClass, SpawnLocation, SpawnRotation, SpawnParams);
+	return true;
+}
 
-	return NewProj ? EBTNodeResult::Succeeded : EBTNodeResult::Failed;
+EBTNodeResult::Type URogueBTTask_RangedAttack::ExecuteTask(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory)
+{
+	return QueueShot(OwnerComp) ? EBTNodeResult::Succeeded : EBTNodeResult::Failed;
 }
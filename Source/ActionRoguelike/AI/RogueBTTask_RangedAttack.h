@@ -4,6 +4,7 @@
 
 #include "CoreMinimal.h"
 #include "BehaviorTree/BTTaskNode.h"
+#include "Engine/StreamableManager.h"
 #include "RogueBTTask_RangedAttack.generated.h"
 
 class ARogueProjectile;
@@ -15,6 +16,8 @@ UCLASS()
 class ACTIONROGUELIKE_API URogueBTTask_RangedAttack : public UBTTaskNode
 {
 	GENERATED_BODY()
+
+protected:
 	URogueBTTask_RangedAttack();
 	
 	UPROPERTY(EditAnywhere, Category="AI")
@@ -29,5 +32,13 @@ class ACTIONROGUELIKE_API URogueBTTask_RangedAttack : public UBTTaskNode
 	UPROPERTY(EditAnywhere, Category = "AI")
 	float MaxBulletSpread = 5.0f;
 
+	/* Adds a single shot to this frame's volley, false when there is nothing to shoot at */
+	bool QueueShot(UBehaviorTreeComponent& OwnerComp) const;
+
+	/* Keeps the projectile's soft referenced effects loaded, the task is not an action so the preload subsystem never sees it */
+	TSharedPtr<FStreamableHandle> ProjectileAssetsHandle;
+
+	virtual void InitializeFromAsset(UBehaviorTree& Asset) override;
+
 	virtual EBTNodeResult::Type ExecuteTask(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory) override;
 };
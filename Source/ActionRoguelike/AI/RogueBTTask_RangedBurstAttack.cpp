@@ -0,0 +1,74 @@
+﻿#include "RogueBTTask_RangedBurstAttack.h"
+
+#include "ActionRoguelike.h"
+#include "AIController.h"
+#include "RogueAILODSubsystem.h"
+
+DECLARE_DWORD_COUNTER_STAT(TEXT("Burst Attack Task Ticks"), STAT_BurstAttackTaskTicks, STATGROUP_ActionRoguelike);
+
+URogueBTTask_RangedBurstAttack::URogueBTTask_RangedBurstAttack()
+{
+	NodeName = "Ranged Burst Attack";
+	bNotifyTick = true;
+	bTickIntervals = true;
+}
+
+EBTNodeResult::Type URogueBTTask_RangedBurstAttack::ExecuteTask(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory)
+{
+	if (!QueueShot(OwnerComp))
+	{
+		return EBTNodeResult::Failed;
+	}
+
+	FRogueBurstAttackMemory* Memory = CastInstanceNodeMemory<FRogueBurstAttackMemory>(NodeMemory);
+	Memory->ShotsRemaining = BurstCount - 1;
+	Memory->TimeUntilNextShot = BurstInterval;
+
+	ScheduleNextShot(OwnerComp, NodeMemory);
+
+	return Memory->ShotsRemaining > 0 ? EBTNodeResult::InProgress : EBTNodeResult::Succeeded;
+}
+
+void URogueBTTask_RangedBurstAttack::TickTask(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory, float DeltaSeconds)
+{
+	INC_DWORD_STAT(STAT_BurstAttackTaskTicks);
+
+	// With tick intervals DeltaSeconds is the full time since the previous task tick
+	FRogueBurstAttackMemory* Memory = CastInstanceNodeMemory<FRogueBurstAttackMemory>(NodeMemory);
+	Memory->TimeUntilNextShot -= DeltaSeconds;
+
+	// Throttled trees receive a larger delta, catch up on all shots that were due since the last tick
+	while (Memory->TimeUntilNextShot <= 0.0f && Memory->ShotsRemaining > 0)
+	{
+		if (!QueueShot(OwnerComp))
+		{
+			FinishLatentTask(OwnerComp, EBTNodeResult::Failed);
+			return;
+		}
+
+		Memory->ShotsRemaining--;
+		Memory->TimeUntilNextShot += BurstInterval;
+	}
+
+	if (Memory->ShotsRemaining == 0)
+	{
+		FinishLatentTask(OwnerComp, EBTNodeResult::Succeeded);
+		return;
+	}
+
+	ScheduleNextShot(OwnerComp, NodeMemory);
+}
+
+void URogueBTTask_RangedBurstAttack::ScheduleNextShot(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory) const
+{
+	// Sleep until the next shot is due instead of ticking every frame, throttled trees sleep at least their LOD interval
+	FRogueBurstAttackMemory* Memory = CastInstanceNodeMemory<FRogueBurstAttackMemory>(NodeMemory);
+	float LODTickInterval = GetWorld()->GetSubsystem<URogueAILODSubsystem>()->GetBehaviorTickInterval(OwnerComp.GetAIOwner());
+
+	SetNextTickTime(NodeMemory, FMath::Max(Memory->TimeUntilNextShot, LODTickInterval));
+}
+
+uint16 URogueBTTask_RangedBurstAttack::GetInstanceMemorySize() const
+{
+	return sizeof(FRogueBurstAttackMemory);
+}
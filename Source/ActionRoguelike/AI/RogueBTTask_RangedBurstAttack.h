@@ -0,0 +1,38 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "RogueBTTask_RangedAttack.h"
+#include "RogueBTTask_RangedBurstAttack.generated.h"
+
+struct FRogueBurstAttackMemory
+{
+	int32 ShotsRemaining = 0;
+
+	float TimeUntilNextShot = 0.0f;
+};
+
+/* Fires BurstCount shots spaced by BurstInterval within a single task execution */
+UCLASS()
+class ACTIONROGUELIKE_API URogueBTTask_RangedBurstAttack : public URogueBTTask_RangedAttack
+{
+	GENERATED_BODY()
+
+protected:
+	URogueBTTask_RangedBurstAttack();
+
+	UPROPERTY(EditAnywhere, Category = "AI", meta=(ClampMin=1))
+	int32 BurstCount = 3;
+
+	UPROPERTY(EditAnywhere, Category = "AI", meta=(ClampMin=0))
+	float BurstInterval = 0.2f;
+
+	virtual EBTNodeResult::Type ExecuteTask(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory) override;
+
+	virtual void TickTask(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory, float DeltaSeconds) override;
+
+	virtual uint16 GetInstanceMemorySize() const override;
+
+	void ScheduleNextShot(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory) const;
+};
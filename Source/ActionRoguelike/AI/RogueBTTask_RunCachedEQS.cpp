@@ -0,0 +1,133 @@
+﻿#include "RogueBTTask_RunCachedEQS.h"
+
+#include "AIController.h"
+#include "RogueBlackboardKeys.h"
+#include "RogueEQSCacheSubsystem.h"
+#include "RogueGameTypes.h"
+#include "BehaviorTree/BehaviorTreeComponent.h"
+#include "EnvironmentQuery/EnvQueryManager.h"
+
+
+URogueBTTask_RunCachedEQS::URogueBTTask_RunCachedEQS()
+{
+	NodeName = "Run Cached EQS";
+
+	TargetActorKey.SelectedKeyName = NAME_TargetActor;
+	TargetActorKey.AddObjectFilter(this, GET_MEMBER_NAME_CHECKED(ThisClass, TargetActorKey), AActor::StaticClass());
+	ResultKey.AddVectorFilter(this, GET_MEMBER_NAME_CHECKED(ThisClass, ResultKey));
+}
+
+void URogueBTTask_RunCachedEQS::InitializeFromAsset(UBehaviorTree& Asset)
+{
+	Super::InitializeFromAsset(Asset);
+
+	if (UBlackboardData* BBAsset = GetBlackboardAsset())
+	{
+		TargetActorKey.ResolveSelectedKey(*BBAsset);
+		ResultKey.ResolveSelectedKey(*BBAsset);
+	}
+}
+
+EBTNodeResult::Type URogueBTTask_RunCachedEQS::ExecuteTask(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory)
+{
+	APawn* Pawn = OwnerComp.GetAIOwner()->GetPawn();
+	AActor* TargetActor = RogueBlackboard::GetActor(OwnerComp.GetBlackboardComponent(), TargetActorKey.GetSelectedKeyID());
+	if (Pawn == nullptr || TargetActor == nullptr || QueryTemplate == nullptr)
+	{
+		return EBTNodeResult::Failed;
+	}
+
+	URogueEQSCacheSubsystem* EQSCache = GetWorld()->GetSubsystem<URogueEQSCacheSubsystem>();
+	if (TSharedPtr<FEnvQueryResult> CachedResult = EQSCache->FindResult(QueryTemplate, TargetActor, Pawn->GetActorLocation()))
+	{
+		return ApplyResult(OwnerComp, *CachedResult) ? EBTNodeResult::Succeeded : EBTNodeResult::Failed;
+	}
+
+	FRogueRunCachedEQSMemory* Memory = CastInstanceNodeMemory<FRogueRunCachedEQSMemory>(NodeMemory);
+	Memory->TargetActor = TargetActor;
+	Memory->QuerierLocation = Pawn->GetActorLocation();
+	Memory->TargetLocation = TargetActor->GetActorLocation();
+
+	FEnvQueryRequest QueryRequest(QueryTemplate, Pawn);
+	Memory->RequestID = QueryRequest.Execute(RunMode, FQueryFinishedSignature::CreateUObject(this, &ThisClass::OnQueryFinished));
+
+	return Memory->RequestID != INDEX_NONE ? EBTNodeResult::InProgress : EBTNodeResult::Failed;
+}
+
+EBTNodeResult::Type URogueBTTask_RunCachedEQS::AbortTask(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory)
+{
+	FRogueRunCachedEQSMemory* Memory = CastInstanceNodeMemory<FRogueRunCachedEQSMemory>(NodeMemory);
+	if (Memory->RequestID != INDEX_NONE)
+	{
+		if (UEnvQueryManager* QueryManager = UEnvQueryManager::GetCurrent(OwnerComp.GetWorld()))
+		{
+			QueryManager->AbortQuery(Memory->RequestID);
+		}
+		Memory->RequestID = INDEX_NONE;
+	}
+
+	return EBTNodeResult::Aborted;
+}
+
+void URogueBTTask_RunCachedEQS::OnQueryFinished(TSharedPtr<FEnvQueryResult> Result)
+{
+	if (Result->IsAborted())
+	{
+		return;
+	}
+
+	// Node is shared between all trees using the asset, find the tree that issued this query through the querier
+	APawn* Pawn = Cast<APawn>(Result->Owner.Get());
+	AAIController* Controller = Pawn ? Cast<AAIController>(Pawn->GetController()) : nullptr;
+	UBehaviorTreeComponent* OwnerComp = Controller ? Cast<UBehaviorTreeComponent>(Controller->GetBrainComponent()) : nullptr;
+	if (OwnerComp == nullptr)
+	{
+		return;
+	}
+
+	uint8* NodeMemory = OwnerComp->GetNodeMemory(this, OwnerComp->FindInstanceContainingNode(this));
+	FRogueRunCachedEQSMemory* Memory = NodeMemory ? CastInstanceNodeMemory<FRogueRunCachedEQSMemory>(NodeMemory) : nullptr;
+	if (Memory == nullptr || Memory->RequestID != Result->QueryID)
+	{
+		return;
+	}
+	Memory->RequestID = INDEX_NONE;
+
+	if (Result->IsSuccessful())
+	{
+		URogueEQSCacheSubsystem* EQSCache = GetWorld()->GetSubsystem<URogueEQSCacheSubsystem>();
+		EQSCache->StoreResult(QueryTemplate, Memory->TargetActor.ResolveObjectPtr(), Memory->QuerierLocation,
+		                      Memory->TargetLocation, Result);
+	}
+
+	bool bSuccess = Result->IsSuccessful() && ApplyResult(*OwnerComp, *Result);
+	FinishLatentTask(*OwnerComp, bSuccess ? EBTNodeResult::Succeeded : EBTNodeResult::Failed);
+}
+
+bool URogueBTTask_RunCachedEQS::ApplyResult(UBehaviorTreeComponent& OwnerComp, const FEnvQueryResult& Result) const
+{
+	if (Result.Items.IsEmpty())
+	{
+		return false;
+	}
+
+	RogueBlackboard::SetVector(OwnerComp.GetBlackboardComponent(), ResultKey.GetSelectedKeyID(), Result.GetItemAsLocation(0));
+	return true;
+}
+
+void URogueBTTask_RunCachedEQS::InitializeMemory(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory,
+                                                 EBTMemoryInit::Type InitType) const
+{
+	InitializeNodeMemory<FRogueRunCachedEQSMemory>(NodeMemory, InitType);
+}
+
+void URogueBTTask_RunCachedEQS::CleanupMemory(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory,
+                                              EBTMemoryClear::Type CleanupType) const
+{
+	CleanupNodeMemory<FRogueRunCachedEQSMemory>(NodeMemory, CleanupType);
+}
+
+uint16 URogueBTTask_RunCachedEQS::GetInstanceMemorySize() const
+{
+	return sizeof(FRogueRunCachedEQSMemory);
+}
@@ -0,0 +1,63 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "BehaviorTree/BTTaskNode.h"
+#include "EnvironmentQuery/EnvQueryTypes.h"
+#include "RogueBTTask_RunCachedEQS.generated.h"
+
+class UEnvQuery;
+
+struct FRogueRunCachedEQSMemory
+{
+	int32 RequestID = INDEX_NONE;
+
+	/* Cache key inputs from the moment the query was issued */
+	TObjectKey<AActor> TargetActor;
+
+	FVector QuerierLocation = FVector::ZeroVector;
+
+	FVector TargetLocation = FVector::ZeroVector;
+};
+
+/**
+ * Runs an EQS query and writes the best location to a blackboard key, reusing recent results of nearby AI against the same target
+ */
+UCLASS()
+class ACTIONROGUELIKE_API URogueBTTask_RunCachedEQS : public UBTTaskNode
+{
+	GENERATED_BODY()
+
+protected:
+	URogueBTTask_RunCachedEQS();
+
+	UPROPERTY(EditAnywhere, Category = "AI")
+	TObjectPtr<UEnvQuery> QueryTemplate;
+
+	UPROPERTY(EditAnywhere, Category = "AI")
+	TEnumAsByte<EEnvQueryRunMode::Type> RunMode = EEnvQueryRunMode::SingleResult;
+
+	UPROPERTY(EditAnywhere, Category = "AI")
+	FBlackboardKeySelector TargetActorKey;
+
+	/* Receives the location of the best item */
+	UPROPERTY(EditAnywhere, Category = "AI")
+	FBlackboardKeySelector ResultKey;
+
+	void OnQueryFinished(TSharedPtr<FEnvQueryResult> Result);
+
+	bool ApplyResult(UBehaviorTreeComponent& OwnerComp, const FEnvQueryResult& Result) const;
+
+	virtual void InitializeFromAsset(UBehaviorTree& Asset) override;
+
+	virtual EBTNodeResult::Type ExecuteTask(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory) override;
+
+	virtual EBTNodeResult::Type AbortTask(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory) override;
+
+	virtual void InitializeMemory(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory, EBTMemoryInit::Type InitType) const override;
+
+	virtual void CleanupMemory(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory, EBTMemoryClear::Type CleanupType) const override;
+
+	virtual uint16 GetInstanceMemorySize() const override;
+};
@@ -0,0 +1,106 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "RogueBlackboardKeys.h"
+
+#include "EngineUtils.h"
+#include "RogueAIController.h"
+#include "RogueGameTypes.h"
+#include "BehaviorTree/BlackboardData.h"
+
+
+const FRogueBlackboardKeys& FRogueBlackboardKeys::Get(const UBlackboardData* InBlackboardAsset)
+{
+	check(IsInGameThread());
+
+	// Heap allocated so references stay valid when the map grows
+	static TMap<TObjectKey<UBlackboardData>, TUniquePtr<FRogueBlackboardKeys>> KeysByAsset;
+
+	if (const TUniquePtr<FRogueBlackboardKeys>* ExistingKeys = KeysByAsset.Find(InBlackboardAsset))
+	{
+		return **ExistingKeys;
+	}
+
+	// Drop assets unloaded since, eg. between PIE sessions
+	for (auto It = KeysByAsset.CreateIterator(); It; ++It)
+	{
+		if (It.Key().ResolveObjectPtr() == nullptr)
+		{
+			It.RemoveCurrent();
+		}
+	}
+
+	TUniquePtr<FRogueBlackboardKeys>& Keys = KeysByAsset.Add(InBlackboardAsset, MakeUnique<FRogueBlackboardKeys>());
+	if (InBlackboardAsset)
+	{
+		Keys->TargetActor = InBlackboardAsset->GetKeyID(NAME_TargetActor);
+		Keys->HealthPercent = InBlackboardAsset->GetKeyID(NAME_HealPercent);
+	}
+	return *Keys;
+}
+
+#if !UE_BUILD_SHIPPING
+static void BenchmarkBlackboardKeys(UWorld* World)
+{
+	constexpr int32 NumAgents = 500;
+	constexpr int32 Iterations = 1000;
+
+	// Keys are resolved per blackboard asset up front, controllers may not all share the same one
+	TArray<UBlackboardComponent*> Blackboards;
+	TArray<FBlackboard::FKey> TargetActorKeys;
+	for (TActorIterator<ARogueAIController> It(World); It; ++It)
+	{
+		UBlackboardComponent* Blackboard = It->GetBlackboardComponent();
+		if (Blackboard == nullptr)
+		{
+			continue;
+		}
+
+		FBlackboard::FKey TargetActorKey = FRogueBlackboardKeys::Get(Blackboard->GetBlackboardAsset()).TargetActor;
+		if (TargetActorKey != FBlackboard::InvalidKey)
+		{
+			Blackboards.Add(Blackboard);
+			TargetActorKeys.Add(TargetActorKey);
+		}
+	}
+
+	if (Blackboards.IsEmpty())
+	{
+		UE_LOG(LogTemp, Warning, TEXT("No AI blackboards found to benchmark"));
+		return;
+	}
+
+	// Cycle through the available blackboards to simulate reads across a full crowd
+	UObject* Sink = nullptr;
+	double StartTime = FPlatformTime::Seconds();
+	for (int32 It = 0; It < Iterations; It++)
+	{
+		for (int32 Agent = 0; Agent < NumAgents; Agent++)
+		{
+			Sink = Blackboards[Agent % Blackboards.Num()]->GetValueAsObject(NAME_TargetActor);
+		}
+	}
+	double ByNameTime = FPlatformTime::Seconds() - StartTime;
+
+	StartTime = FPlatformTime::Seconds();
+	for (int32 It = 0; It < Iterations; It++)
+	{
+		for (int32 Agent = 0; Agent < NumAgents; Agent++)
+		{
+			const int32 Index = Agent % Blackboards.Num();
+			Sink = RogueBlackboard::GetActor(Blackboards[Index], TargetActorKeys[Index]);
+		}
+	}
+	double ByKeyTime = FPlatformTime::Seconds() - StartTime;
+
+	UE_LOG(LogTemp, Log, TEXT("Blackboard reads for %d agents: by name %.3f us, by key %.3f us (%s)"),
+	       NumAgents,
+	       ByNameTime / Iterations * 1000000.0,
+	       ByKeyTime / Iterations * 1000000.0,
+	       *GetNameSafe(Sink));
+}
+
+static FAutoConsoleCommandWithWorld BenchmarkBlackboardKeysCommand(TEXT("game.ai.BenchmarkBlackboardKeys"),
+                                                                   TEXT("Compare blackboard reads by name and by cached key for a 500 agent crowd."),
+                                                                   FConsoleCommandWithWorldDelegate::CreateStatic(&BenchmarkBlackboardKeys));
+#endif
@@ -0,0 +1,63 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/ObjectKey.h"
+#include "BehaviorTree/BlackboardComponent.h"
+#include "BehaviorTree/Blackboard/BlackboardKeyType_Bool.h"
+#include "BehaviorTree/Blackboard/BlackboardKeyType_Float.h"
+#include "BehaviorTree/Blackboard/BlackboardKeyType_Object.h"
+#include "BehaviorTree/Blackboard/BlackboardKeyType_Vector.h"
+
+class UBlackboardData;
+
+/* Key IDs of the shared blackboard names in RogueGameTypes.h, resolved once per blackboard asset */
+struct ACTIONROGUELIKE_API FRogueBlackboardKeys
+{
+	FBlackboard::FKey TargetActor = FBlackboard::InvalidKey;
+
+	FBlackboard::FKey HealthPercent = FBlackboard::InvalidKey;
+
+	/* The result stays valid while InBlackboardAsset is loaded, copy it to keep it longer */
+	static const FRogueBlackboardKeys& Get(const UBlackboardData* InBlackboardAsset);
+};
+
+/* Typed access by resolved key, skips the name to key lookup of the GetValueAs/SetValueAs functions */
+namespace RogueBlackboard
+{
+	inline AActor* GetActor(const UBlackboardComponent* InBlackboard, FBlackboard::FKey InKey)
+	{
+		return Cast<AActor>(InBlackboard->GetValue<UBlackboardKeyType_Object>(InKey));
+	}
+
+	inline void SetObject(UBlackboardComponent* InBlackboard, FBlackboard::FKey InKey, UObject* InValue)
+	{
+		InBlackboard->SetValue<UBlackboardKeyType_Object>(InKey, InValue);
+	}
+
+	inline bool GetBool(const UBlackboardComponent* InBlackboard, FBlackboard::FKey InKey)
+	{
+		return InBlackboard->GetValue<UBlackboardKeyType_Bool>(InKey);
+	}
+
+	inline void SetBool(UBlackboardComponent* InBlackboard, FBlackboard::FKey InKey, bool bInValue)
+	{
+		InBlackboard->SetValue<UBlackboardKeyType_Bool>(InKey, bInValue);
+	}
+
+	inline float GetFloat(const UBlackboardComponent* InBlackboard, FBlackboard::FKey InKey)
+	{
+		return InBlackboard->GetValue<UBlackboardKeyType_Float>(InKey);
+	}
+
+	inline void SetFloat(UBlackboardComponent* InBlackboard, FBlackboard::FKey InKey, float InValue)
+	{
+		InBlackboard->SetValue<UBlackboardKeyType_Float>(InKey, InValue);
+	}
+
+	inline void SetVector(UBlackboardComponent* InBlackboard, FBlackboard::FKey InKey, const FVector& InValue)
+	{
+		InBlackboard->SetValue<UBlackboardKeyType_Vector>(InKey, InValue);
+	}
+}
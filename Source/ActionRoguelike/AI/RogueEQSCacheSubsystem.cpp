@@ -0,0 +1,115 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "RogueEQSCacheSubsystem.h"
+
+#include "ActionRoguelike.h"
+#include "EnvironmentQuery/EnvQuery.h"
+#include "EnvironmentQuery/EnvQueryTypes.h"
+
+TAutoConsoleVariable<bool> CVarEQSCache(TEXT("game.ai.EQSCache"), true,
+                                        TEXT("Share EQS results between nearby AI running the same query. (0 = Off, 1 = enabled)"),
+                                        ECVF_Cheat);
+
+DECLARE_DWORD_COUNTER_STAT(TEXT("EQS Cache Hits"), STAT_EQSCacheHits, STATGROUP_ActionRoguelike);
+DECLARE_DWORD_COUNTER_STAT(TEXT("EQS Cache Misses"), STAT_EQSCacheMisses, STATGROUP_ActionRoguelike);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("EQS Cache Entries"), STAT_EQSCacheEntries, STATGROUP_ActionRoguelike);
+
+/* Stale entries are only purged when adding, a full pass is not worth it for a handful of entries */
+static constexpr int32 PurgeEntryThreshold = 128;
+
+
+TSharedPtr<FEnvQueryResult> URogueEQSCacheSubsystem::FindResult(const UEnvQuery* QueryTemplate,
+                                                               const AActor* TargetActor,
+                                                               const FVector& QuerierLocation)
+{
+	if (!CVarEQSCache.GetValueOnGameThread())
+	{
+		return nullptr;
+	}
+
+	FRogueEQSCacheKey Key = MakeKey(QueryTemplate, TargetActor, QuerierLocation);
+	const FRogueEQSCacheEntry* Entry = Entries.Find(Key);
+	if (Entry == nullptr || !IsEntryFresh(*Entry, TargetActor))
+	{
+		INC_DWORD_STAT(STAT_EQSCacheMisses);
+		return nullptr;
+	}
+
+	INC_DWORD_STAT(STAT_EQSCacheHits);
+	return Entry->Result;
+}
+
+void URogueEQSCacheSubsystem::StoreResult(const UEnvQuery* QueryTemplate, const AActor* TargetActor,
+                                          const FVector& QuerierLocation, const FVector& TargetLocation,
+                                          TSharedPtr<FEnvQueryResult> Result)
+{
+	if (!CVarEQSCache.GetValueOnGameThread())
+	{
+		return;
+	}
+
+	if (Entries.Num() >= PurgeEntryThreshold)
+	{
+		RemoveStaleEntries();
+	}
+
+	FRogueEQSCacheEntry& Entry = Entries.FindOrAdd(MakeKey(QueryTemplate, TargetActor, QuerierLocation));
+	Entry.Result = Result;
+	Entry.TargetLocation = TargetLocation;
+	Entry.TimeStamp = GetWorld()->TimeSeconds;
+
+	SET_DWORD_STAT(STAT_EQSCacheEntries, Entries.Num());
+}
+
+void URogueEQSCacheSubsystem::InvalidateTarget(const AActor* TargetActor)
+{
+	TObjectKey<AActor> TargetKey(TargetActor);
+	for (auto It = Entries.CreateIterator(); It; ++It)
+	{
+		if (It->Key.TargetActor == TargetKey)
+		{
+			It.RemoveCurrent();
+		}
+	}
+
+	SET_DWORD_STAT(STAT_EQSCacheEntries, Entries.Num());
+}
+
+bool URogueEQSCacheSubsystem::IsEntryFresh(const FRogueEQSCacheEntry& Entry, const AActor* TargetActor) const
+{
+	if (GetWorld()->TimeSeconds - Entry.TimeStamp > TimeToLive || TargetActor == nullptr)
+	{
+		return false;
+	}
+
+	return FVector::DistSquared(Entry.TargetLocation, TargetActor->GetActorLocation()) < FMath::Square(TargetMoveThreshold);
+}
+
+void URogueEQSCacheSubsystem::RemoveStaleEntries()
+{
+	for (auto It = Entries.CreateIterator(); It; ++It)
+	{
+		if (!IsEntryFresh(It->Value, It->Key.TargetActor.ResolveObjectPtr()))
+		{
+			It.RemoveCurrent();
+		}
+	}
+}
+
+FRogueEQSCacheKey URogueEQSCacheSubsystem::MakeKey(const UEnvQuery* QueryTemplate, const AActor* TargetActor,
+                                                   const FVector& QuerierLocation) const
+{
+	FRogueEQSCacheKey Key;
+	Key.QueryTemplate = QueryTemplate;
+	Key.TargetActor = TargetActor;
+	Key.QuerierCell = FIntVector(FMath::FloorToInt32(QuerierLocation.X / CellSize),
+	                             FMath::FloorToInt32(QuerierLocation.Y / CellSize),
+	                             FMath::FloorToInt32(QuerierLocation.Z / CellSize));
+	return Key;
+}
+
+bool URogueEQSCacheSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
@@ -0,0 +1,81 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "RogueEQSCacheSubsystem.generated.h"
+
+class UEnvQuery;
+struct FEnvQueryResult;
+
+struct FRogueEQSCacheKey
+{
+	TObjectKey<UEnvQuery> QueryTemplate;
+
+	TObjectKey<AActor> TargetActor;
+
+	/* Querier location quantized to CellSize, nearby queriers share the same results */
+	FIntVector QuerierCell = FIntVector::ZeroValue;
+
+	bool operator==(const FRogueEQSCacheKey& Other) const
+	{
+		return QueryTemplate == Other.QueryTemplate && TargetActor == Other.TargetActor && QuerierCell == Other.QuerierCell;
+	}
+
+	friend uint32 GetTypeHash(const FRogueEQSCacheKey& Key)
+	{
+		return HashCombine(HashCombine(GetTypeHash(Key.QueryTemplate), GetTypeHash(Key.TargetActor)),
+		                   GetTypeHash(Key.QuerierCell));
+	}
+};
+
+struct FRogueEQSCacheEntry
+{
+	TSharedPtr<FEnvQueryResult> Result;
+
+	/* Target location at the time the query ran, moving beyond TargetMoveThreshold invalidates the entry */
+	FVector TargetLocation = FVector::ZeroVector;
+
+	double TimeStamp = 0.0;
+};
+
+/* Shares EQS results between queriers running the same query against the same target from roughly the same place */
+UCLASS(Config=Game)
+class ACTIONROGUELIKE_API URogueEQSCacheSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	/* Null when there is no fresh result for this querier location */
+	TSharedPtr<FEnvQueryResult> FindResult(const UEnvQuery* QueryTemplate, const AActor* TargetActor,
+	                                       const FVector& QuerierLocation);
+
+	void StoreResult(const UEnvQuery* QueryTemplate, const AActor* TargetActor, const FVector& QuerierLocation,
+	                 const FVector& TargetLocation, TSharedPtr<FEnvQueryResult> Result);
+
+	/* Drops every result involving TargetActor, called by ARoguePlayerCharacter::TeleportTo */
+	void InvalidateTarget(const AActor* TargetActor);
+
+protected:
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+	FRogueEQSCacheKey MakeKey(const UEnvQuery* QueryTemplate, const AActor* TargetActor,
+	                          const FVector& QuerierLocation) const;
+
+	bool IsEntryFresh(const FRogueEQSCacheEntry& Entry, const AActor* TargetActor) const;
+
+	void RemoveStaleEntries();
+
+	UPROPERTY(Config)
+	float CellSize = 300.0f;
+
+	/* Seconds a result can be reused */
+	UPROPERTY(Config)
+	float TimeToLive = 1.0f;
+
+	UPROPERTY(Config)
+	float TargetMoveThreshold = 200.0f;
+
+	TMap<FRogueEQSCacheKey, FRogueEQSCacheEntry> Entries;
+};
@@ -3,9 +3,8 @@
 
 #include "RogueEnvQueryContext_TargetActor.h"
 
-#include "AIController.h"
-#include "RogueGameTypes.h"
-#include "BehaviorTree/BlackboardComponent.h"
+#include "RogueAIController.h"
+#include "RogueBlackboardKeys.h"
 #include "EnvironmentQuery/EnvQueryTypes.h"
 #include "EnvironmentQuery/Items/EnvQueryItemType_Actor.h"
 
@@ -16,10 +15,11 @@ void URogueEnvQueryContext_TargetActor::ProvideContext(FEnvQueryInstance& QueryI
 	APawn* QuerierPawn = Cast<APawn>(QueryInstance.Owner.Get());
 	if (ensure(QuerierPawn))
 	{
-		AAIController* Controller = Cast<AAIController>(QuerierPawn->GetController());
+		ARogueAIController* Controller = Cast<ARogueAIController>(QuerierPawn->GetController());
 		check(Controller);
 		
-		AActor* TargetActor = Cast<AActor>(Controller->GetBlackboardComponent()->GetValueAsObject(NAME_TargetActor));
+		AActor* TargetActor = RogueBlackboard::GetActor(Controller->GetBlackboardComponent(),
+		                                                Controller->GetBlackboardKeys().TargetActor);
 		UEnvQueryItemType_Actor::SetContextHelper(ContextData, TargetActor);
 	}
 }
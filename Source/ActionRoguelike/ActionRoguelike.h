@@ -4,3 +4,6 @@
 
 #include "CoreMinimal.h"
 
+/* Use 'stat ActionRoguelike' in the console to profile the gameplay systems */
+DECLARE_STATS_GROUP(TEXT("ActionRoguelike"), STATGROUP_ActionRoguelike, STATCAT_Advanced);
+
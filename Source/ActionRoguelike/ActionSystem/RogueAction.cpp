@@ -1,11 +1,21 @@
 ﻿#include "RogueAction.h"
 #include "RogueActionSystemComponent.h"
 
+void URogueAction::Initialize(URogueActionSystemComponent* InOwningComponent, int32 InActionSlot)
+{
+	OwningComponent = InOwningComponent;
+	ActionSlot = InActionSlot;
+
+	GrantTagMask = FRogueGameplayTagMask::FromContainer(GrantTags, true);
+	BlockedTagMask = FRogueGameplayTagMask::FromContainer(BlockedTags, false);
+}
+
 void URogueAction::StartAction_Implementation()
 {
-	bIsRunning = true;
 	float GameTime = GetWorld()->TimeSeconds;
-	GetOwningComponent()->ActiveGameplayTags.AppendTags(GrantTags);
+
+	OwningComponent->SetActionRunning(ActionSlot, true);
+	OwningComponent->ActiveGameplayTags.AddTags(GrantTagMask);
 
 	UE_LOGFMT(LogTemp, Log, "Started Action {ActionName} - {WorldTime}",
 	          ("ActionName", ActionName.ToString()),
@@ -14,11 +24,17 @@ void URogueAction::StartAction_Implementation()
 
 void URogueAction::StopAction_Implementation()
 {
-	bIsRunning = false;
+	// Removed from its component, eg. a delayed stop arriving after RemoveAction already stopped it
+	if (ActionSlot == INDEX_NONE)
+	{
+		return;
+	}
+
 	float GameTime = GetWorld()->TimeSeconds;
-	CooldownUntil = GetWorld()->TimeSeconds + CooldownTime;
 
-	GetOwningComponent()->ActiveGameplayTags.RemoveTags(GrantTags);
+	OwningComponent->SetActionRunning(ActionSlot, false);
+	OwningComponent->StartActionCooldown(ActionSlot, CooldownTime);
+	OwningComponent->ActiveGameplayTags.RemoveTags(GrantTagMask);
 
 	UE_LOGFMT(LogTemp, Log, "Stopped Action {ActionName} - {WorldTime}",
 	          ("ActionName", ActionName.ToString()),
@@ -27,28 +43,34 @@ void URogueAction::StopAction_Implementation()
 
 URogueActionSystemComponent* URogueAction::GetOwningComponent() const
 {
-	return Cast<URogueActionSystemComponent>(GetOuter());
+	return OwningComponent;
 }
 
 bool URogueAction::IsRunning() const
 {
-	return bIsRunning;
+	if (ActionSlot == INDEX_NONE)
+	{
+		return false;
+	}
+
+	return OwningComponent->IsActionRunning(ActionSlot);
 }
 
 bool URogueAction::CanStart() const
 {
-	if (IsRunning())
+	if (ActionSlot == INDEX_NONE || IsRunning())
 	{
 		return false;
 	}
 
-	if (GetCooldownTimeRemaining() > 0.0f)
+	float CooldownRemaining = GetCooldownTimeRemaining();
+	if (CooldownRemaining > 0.0f)
 	{
-		UE_LOG(LogTemp, Log, TEXT("Cooldown remaining: %f"), GetCooldownTimeRemaining());
+		UE_LOG(LogTemp, Log, TEXT("Cooldown remaining: %f"), CooldownRemaining);
 		return false;
 	}
 
-	if (GetOwningComponent()->ActiveGameplayTags.HasAny(BlockedTags))
+	if (OwningComponent->ActiveGameplayTags.HasAny(BlockedTagMask))
 	{
 		return false;
 	}
@@ -58,5 +80,10 @@ bool URogueAction::CanStart() const
 
 float URogueAction::GetCooldownTimeRemaining() const
 {
-	return FMath::Max(0.0f, CooldownUntil - GetWorld()->TimeSeconds);
+	if (ActionSlot == INDEX_NONE)
+	{
+		return 0.0f;
+	}
+
+	return OwningComponent->GetActionCooldownRemaining(ActionSlot);
 }
@@ -4,6 +4,7 @@
 
 #include "CoreMinimal.h"
 #include "GameplayTagContainer.h"
+#include "RogueGameplayTagMask.h"
 #include "UObject/Object.h"
 #include "RogueAction.generated.h"
 
@@ -25,6 +26,8 @@ public:
 	UFUNCTION(BlueprintCallable)
 	URogueActionSystemComponent* GetOwningComponent() const;
 
+	void Initialize(URogueActionSystemComponent* InOwningComponent, int32 InActionSlot);
+
 	bool IsRunning() const;
 	bool CanStart() const;
 	float GetCooldownTimeRemaining() const;
@@ -35,22 +38,41 @@ public:
 	UFUNCTION(BlueprintNativeEvent, Category= "Actions")
 	void StopAction();
 
+	/* Soft referenced assets to stream in once the action is granted, may add more once earlier ones have loaded */
+	virtual void GetAssetsToPreload(TArray<FSoftObjectPath>& OutAssetPaths) const {}
+
 	FGameplayTag GetActionName() const
 	{
 		return ActionName;
 	}
 
+	const FRogueGameplayTagMask& GetBlockedTagMask() const
+	{
+		return BlockedTagMask;
+	}
+
+	/* Index of this action's runtime state (running, cooldown) in the owning component */
+	int32 GetActionSlot() const
+	{
+		return ActionSlot;
+	}
+
 protected:
-	UPROPERTY(Transient)
-	float CooldownUntil = 0;
+	friend URogueActionSystemComponent;
 
 	UPROPERTY(Transient)
-	bool bIsRunning = false;
+	TObjectPtr<URogueActionSystemComponent> OwningComponent;
 
+	int32 ActionSlot = INDEX_NONE;
 
 	UPROPERTY(EditDefaultsOnly, Category="Actions")
 	FGameplayTagContainer GrantTags;
 
 	UPROPERTY(EditDefaultsOnly, Category="Actions")
 	FGameplayTagContainer BlockedTags;
+
+	/* GrantTags including their parents and BlockedTags as is, compiled once in Initialize */
+	FRogueGameplayTagMask GrantTagMask;
+
+	FRogueGameplayTagMask BlockedTagMask;
 };
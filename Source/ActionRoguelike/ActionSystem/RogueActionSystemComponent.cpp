@@ -1,7 +1,20 @@
 ﻿#include "RogueActionSystemComponent.h"
 
+#include "ActionRoguelike.h"
 #include "RogueAction.h"
 #include "RogueAttributeSet.h"
+#include "Core/RogueAssetPreloadSubsystem.h"
+#include "SharedGameplayTags.h"
+#include "EngineUtils.h"
+
+DECLARE_CYCLE_STAT(TEXT("StartAction"), STAT_StartAction, STATGROUP_ActionRoguelike);
+DECLARE_CYCLE_STAT(TEXT("StopAction"), STAT_StopAction, STATGROUP_ActionRoguelike);
+DECLARE_CYCLE_STAT(TEXT("ApplyAttributeChange"), STAT_ApplyAttributeChange, STATGROUP_ActionRoguelike);
+DECLARE_CYCLE_STAT(TEXT("FlushAttributeBatch"), STAT_FlushAttributeBatch, STATGROUP_ActionRoguelike);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Attribute Events Broadcast"), STAT_AttributeEventsBroadcast, STATGROUP_ActionRoguelike);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Attribute Changes Batched"), STAT_AttributeChangesBatched, STATGROUP_ActionRoguelike);
+
+FRogueAttributeBatchGroup* FRogueAttributeBatchGroup::Active = nullptr;
 
 URogueActionSystemComponent::URogueActionSystemComponent()
 {
@@ -14,16 +27,10 @@ void URogueActionSystemComponent::InitializeComponent()
 	Super::InitializeComponent();
 
 	Attributes = NewObject<URogueAttributeSet>(this, AttributeSetClass);
+	AttributeLayout = &FRogueAttributeLayout::Get(Attributes->GetClass());
 
-	for (TFieldIterator<FStructProperty> PropIt(Attributes->GetClass()); PropIt; ++PropIt)
-	{
-		FRogueAttribute* FoundAttribute = PropIt->ContainerPtrToValuePtr<FRogueAttribute>(Attributes);
-
-		FName AttributeTagName = FName("Attribute." + PropIt->GetName());
-		FGameplayTag AttributeTag = FGameplayTag::RequestGameplayTag(AttributeTagName);
-
-		CachedAttributes.Add(AttributeTag, FoundAttribute);
-	}
+	BatchedOldValues.SetNumZeroed(AttributeLayout->Num());
+	BatchedDirtySlots.Init(false, AttributeLayout->Num());
 
 	for (TSubclassOf<URogueAction> ActionClass : DefaultActions)
 	{
@@ -36,46 +43,202 @@ void URogueActionSystemComponent::InitializeComponent()
 
 void URogueActionSystemComponent::GrantAction(TSubclassOf<URogueAction> NewActionClass)
 {
+	FGameplayTag ActionName = NewActionClass->GetDefaultObject<URogueAction>()->GetActionName();
+	if (!ensureMsgf(!ActionsByName.Contains(ActionName), TEXT("Action %s was already granted"), *ActionName.ToString()))
+	{
+		return;
+	}
+
 	URogueAction* NewAction = NewObject<URogueAction>(this, NewActionClass);
-	Actions.Add(NewAction);
+	int32 ActionSlot = Actions.Add(NewAction);
+	ActionsByName.Add(ActionName, NewAction);
+
+	ActionRunningFlags.Add(false);
+	ActionCoolingDownFlags.Add(false);
+	ActionCooldownUntil.Add(0.0f);
+
+	NewAction->Initialize(this, ActionSlot);
+	ActionBlockedTagMasks.Add(NewAction->GetBlockedTagMask());
+
+	if (URogueAssetPreloadSubsystem* AssetPreloader = GetWorld()->GetSubsystem<URogueAssetPreloadSubsystem>())
+	{
+		AssetPreloader->PreloadAction(NewAction);
+	}
 }
 
-void URogueActionSystemComponent::StartAction(FGameplayTag InActionName)
+void URogueActionSystemComponent::RemoveAction(FGameplayTag InActionName)
 {
-	for (URogueAction* Action : Actions)
+	URogueAction* Action = nullptr;
+	if (!ActionsByName.RemoveAndCopyValue(InActionName, Action))
+	{
+		UE_LOG(LogTemp, Warning, TEXT("No Action found with name %s"), *InActionName.ToString());
+		return;
+	}
+
+	if (Action->IsRunning())
 	{
-		if (Action->GetActionName() == InActionName)
+		Action->StopAction();
+	}
+
+	// Swap the last action into the freed slot to keep the runtime state arrays dense
+	int32 ActionSlot = Action->GetActionSlot();
+	Actions.RemoveAtSwap(ActionSlot);
+	ActionRunningFlags.RemoveAtSwap(ActionSlot);
+	ActionCoolingDownFlags.RemoveAtSwap(ActionSlot);
+	ActionCooldownUntil.RemoveAtSwap(ActionSlot);
+	ActionBlockedTagMasks.RemoveAtSwap(ActionSlot);
+
+	if (Actions.IsValidIndex(ActionSlot))
+	{
+		Actions[ActionSlot]->ActionSlot = ActionSlot;
+	}
+
+	Action->ActionSlot = INDEX_NONE;
+}
+
+URogueAction* URogueActionSystemComponent::FindAction(FGameplayTag InActionName) const
+{
+	return ActionsByName.FindRef(InActionName);
+}
+
+void URogueActionSystemComponent::GetActionsMatchingTag(FGameplayTag InParentTag, TArray<URogueAction*>& OutActions) const
+{
+	for (const TPair<FGameplayTag, URogueAction*>& Pair : ActionsByName)
+	{
+		if (Pair.Key.MatchesTag(InParentTag))
 		{
-			if (Action->CanStart())
-			{
-				Action->StartAction();
-			}
-			return;
+			OutActions.Add(Pair.Value);
 		}
 	}
+}
 
-	UE_LOG(LogTemp, Warning, TEXT("No Action found with name %s"), *InActionName.ToString());
+void URogueActionSystemComponent::GetStartableActions(TArray<URogueAction*>& OutActions) const
+{
+	float GameTime = GetWorld()->TimeSeconds;
+
+	for (int32 ActionSlot = 0; ActionSlot < Actions.Num(); ActionSlot++)
+	{
+		if (ActionRunningFlags[ActionSlot] || ActionCooldownUntil[ActionSlot] > GameTime)
+		{
+			continue;
+		}
+
+		if (ActiveGameplayTags.HasAny(ActionBlockedTagMasks[ActionSlot]))
+		{
+			continue;
+		}
+
+		OutActions.Add(Actions[ActionSlot]);
+	}
 }
 
-void URogueActionSystemComponent::StopAction(FGameplayTag InActionName)
+void URogueActionSystemComponent::SetActionRunning(int32 ActionSlot, bool bIsRunning)
 {
-	for (URogueAction* Action : Actions)
+	ActionRunningFlags[ActionSlot] = bIsRunning;
+}
+
+float URogueActionSystemComponent::GetActionCooldownRemaining(int32 ActionSlot) const
+{
+	return FMath::Max(0.0f, ActionCooldownUntil[ActionSlot] - GetWorld()->TimeSeconds);
+}
+
+void URogueActionSystemComponent::StartActionCooldown(int32 ActionSlot, float CooldownTime)
+{
+	ActionCooldownUntil[ActionSlot] = GetWorld()->TimeSeconds + CooldownTime;
+
+	if (CooldownTime > 0.0f)
+	{
+		ActionCoolingDownFlags[ActionSlot] = true;
+		ScheduleCooldownTimer();
+	}
+}
+
+void URogueActionSystemComponent::ScheduleCooldownTimer()
+{
+	float NextCooldownEnd = TNumericLimits<float>::Max();
+	for (TConstSetBitIterator<> It(ActionCoolingDownFlags); It; ++It)
+	{
+		NextCooldownEnd = FMath::Min(NextCooldownEnd, ActionCooldownUntil[It.GetIndex()]);
+	}
+
+	FTimerManager& TimerManager = GetWorld()->GetTimerManager();
+	if (NextCooldownEnd == TNumericLimits<float>::Max())
+	{
+		TimerManager.ClearTimer(CooldownTimerHandle);
+		return;
+	}
+
+	// SetTimer clears the timer on a zero rate, so an already expired cooldown still needs a minimal delay
+	float Delay = FMath::Max(NextCooldownEnd - GetWorld()->TimeSeconds, KINDA_SMALL_NUMBER);
+	TimerManager.SetTimer(CooldownTimerHandle, this, &ThisClass::OnCooldownTimerElapsed, Delay, false);
+}
+
+void URogueActionSystemComponent::OnCooldownTimerElapsed()
+{
+	float GameTime = GetWorld()->TimeSeconds;
+
+	TArray<URogueAction*, TInlineAllocator<4>> FinishedActions;
+	for (TConstSetBitIterator<> It(ActionCoolingDownFlags); It; ++It)
 	{
-		if (Action->GetActionName() == InActionName)
+		if (ActionCooldownUntil[It.GetIndex()] <= GameTime + KINDA_SMALL_NUMBER)
 		{
-			Action->StopAction();
-			return;
+			FinishedActions.Add(Actions[It.GetIndex()]);
 		}
 	}
 
-	UE_LOG(LogTemp, Warning, TEXT("No Action found with name %s"), *InActionName.ToString());
+	for (URogueAction* Action : FinishedActions)
+	{
+		ActionCoolingDownFlags[Action->GetActionSlot()] = false;
+	}
+
+	ScheduleCooldownTimer();
+
+	// Broadcast last, listeners may start actions again which re-arms the timer
+	for (URogueAction* Action : FinishedActions)
+	{
+		OnActionCooldownFinished.Broadcast(Action);
+	}
+}
+
+void URogueActionSystemComponent::StartAction(FGameplayTag InActionName)
+{
+	SCOPE_CYCLE_COUNTER(STAT_StartAction);
+
+	URogueAction* Action = FindAction(InActionName);
+	if (Action == nullptr)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("No Action found with name %s"), *InActionName.ToString());
+		return;
+	}
+
+	if (Action->CanStart())
+	{
+		Action->StartAction();
+	}
+}
+
+void URogueActionSystemComponent::StopAction(FGameplayTag InActionName)
+{
+	SCOPE_CYCLE_COUNTER(STAT_StopAction);
+
+	URogueAction* Action = FindAction(InActionName);
+	if (Action == nullptr)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("No Action found with name %s"), *InActionName.ToString());
+		return;
+	}
+
+	Action->StopAction();
 }
 
 void URogueActionSystemComponent::ApplyAttributeChange(FGameplayTag AttributeTag, float Delta,
                                                        EAttributeModifyType ModifyType)
 {
-	FRogueAttribute* FoundAttribute = GetAttribute(AttributeTag);
-	check(FoundAttribute);
+	SCOPE_CYCLE_COUNTER(STAT_ApplyAttributeChange);
+
+	int32 Slot = AttributeLayout->FindSlot(AttributeTag);
+	check(Slot != INDEX_NONE);
+	FRogueAttribute* FoundAttribute = Attributes->GetAttributeAt(*AttributeLayout, Slot);
 
 	float OldValue = FoundAttribute->GetValue();
 
@@ -94,22 +257,85 @@ void URogueActionSystemComponent::ApplyAttributeChange(FGameplayTag AttributeTag
 		check(false);
 	}
 
+	// Clamp on every change so a batch ends on the same values as applying the changes one by one
 	Attributes->PostAttributeChanged();
+
+	if (AttributeBatchDepth == 0)
+	{
+		if (FRogueAttributeBatchGroup* BatchGroup = FRogueAttributeBatchGroup::GetActive())
+		{
+			BatchGroup->Add(this);
+		}
+	}
+
+	if (AttributeBatchDepth > 0)
+	{
+		INC_DWORD_STAT(STAT_AttributeChangesBatched);
+
+		// Only the value from before the first change in the batch is reported to listeners
+		if (!BatchedDirtySlots[Slot])
+		{
+			BatchedDirtySlots[Slot] = true;
+			BatchedOldValues[Slot] = OldValue;
+		}
+		return;
+	}
+
+	BroadcastAttributeChanged(AttributeTag, FoundAttribute->GetValue(), OldValue);
+}
+
+void URogueActionSystemComponent::BeginAttributeBatch()
+{
+	AttributeBatchDepth++;
+}
+
+void URogueActionSystemComponent::EndAttributeBatch()
+{
+	check(AttributeBatchDepth > 0);
+
+	AttributeBatchDepth--;
+	if (AttributeBatchDepth > 0)
+	{
+		return;
+	}
+
+	SCOPE_CYCLE_COUNTER(STAT_FlushAttributeBatch);
+
+	for (TConstSetBitIterator<> It(BatchedDirtySlots); It; ++It)
+	{
+		int32 Slot = It.GetIndex();
+		FRogueAttribute* Attribute = Attributes->GetAttributeAt(*AttributeLayout, Slot);
+
+		BroadcastAttributeChanged(AttributeLayout->Tags[Slot], Attribute->GetValue(), BatchedOldValues[Slot]);
+	}
+
+	BatchedDirtySlots.Init(false, BatchedDirtySlots.Num());
+}
+
+void URogueActionSystemComponent::BroadcastAttributeChanged(FGameplayTag AttributeTag, float NewValue, float OldValue)
+{
+	INC_DWORD_STAT(STAT_AttributeEventsBroadcast);
+
 	if (FOnAttributeChanged* Event = AttributeListeners.Find(AttributeTag))
 	{
-		Event->Broadcast(AttributeTag, FoundAttribute->GetValue(), OldValue);
+		Event->Broadcast(AttributeTag, NewValue, OldValue);
 	}
-	
+
 	UE_LOGFMT(LogTemp, Log, "Attribute: {0}, New: {1}, Old: {2}",
 	          AttributeTag.ToString(),
-	          FoundAttribute->GetValue(),
+	          NewValue,
 	          OldValue);
 }
 
 FRogueAttribute* URogueActionSystemComponent::GetAttribute(FGameplayTag InAttributeTag)
 {
-	FRogueAttribute** FoundAttribute = CachedAttributes.Find(InAttributeTag);
-	return *FoundAttribute;
+	int32 Slot = AttributeLayout->FindSlot(InAttributeTag);
+	if (Slot == INDEX_NONE)
+	{
+		return nullptr;
+	}
+
+	return Attributes->GetAttributeAt(*AttributeLayout, Slot);
 }
 
 
@@ -118,3 +344,112 @@ FOnAttributeChanged& URogueActionSystemComponent::GetAttributeListener(FGameplay
 	return AttributeListeners.FindOrAdd(AttributeTag);
 }
 
+
+FRogueAttributeBatchGroup::FRogueAttributeBatchGroup()
+{
+	check(IsInGameThread());
+
+	Outer = Active;
+	Active = this;
+}
+
+FRogueAttributeBatchGroup::~FRogueAttributeBatchGroup()
+{
+	check(Active == this);
+
+	// Restore first, listeners may apply follow-up changes which then go to the outer group or broadcast right away
+	Active = Outer;
+
+	for (const TWeakObjectPtr<URogueActionSystemComponent>& ActionComp : ActionComps)
+	{
+		// Skips components destroyed during the group, their listeners are gone as well
+		if (URogueActionSystemComponent* ActionCompPtr = ActionComp.Get())
+		{
+			ActionCompPtr->EndAttributeBatch();
+		}
+	}
+}
+
+void FRogueAttributeBatchGroup::Add(URogueActionSystemComponent* ActionComp)
+{
+	ActionComp->BeginAttributeBatch();
+	ActionComps.Add(ActionComp);
+}
+
+
+#if !UE_BUILD_SHIPPING
+static void StressAttributeBatching(const TArray<FString>& Args, UWorld* World)
+{
+	int32 ChangesPerComponent = Args.Num() > 0 ? FCString::Atoi(*Args[0]) : 20;
+
+	TArray<URogueActionSystemComponent*> ActionComps;
+	for (TActorIterator<AActor> It(World); It; ++It)
+	{
+		if (URogueActionSystemComponent* ActionComp = It->FindComponentByClass<URogueActionSystemComponent>())
+		{
+			if (ActionComp->GetAttribute(SharedGameplayTags::Attribute_Health))
+			{
+				ActionComps.Add(ActionComp);
+			}
+		}
+	}
+
+	if (ActionComps.IsEmpty())
+	{
+		UE_LOG(LogTemp, Warning, TEXT("No action system components with Health found to stress"));
+		return;
+	}
+
+	int32 NumEvents = 0;
+	TArray<FDelegateHandle> ListenerHandles;
+	for (URogueActionSystemComponent* ActionComp : ActionComps)
+	{
+		ListenerHandles.Add(ActionComp->GetAttributeListener(SharedGameplayTags::Attribute_Health).AddLambda(
+			[&NumEvents](FGameplayTag, float, float)
+			{
+				NumEvents++;
+			}));
+	}
+
+	// Alternating modifier changes cancel out and are never clamped, so both passes leave health untouched
+	auto ApplyChanges = [&]()
+	{
+		for (URogueActionSystemComponent* ActionComp : ActionComps)
+		{
+			for (int32 i = 0; i < ChangesPerComponent; i++)
+			{
+				ActionComp->ApplyAttributeChange(SharedGameplayTags::Attribute_Health, (i % 2 == 0) ? 1.0f : -1.0f, Modifier);
+			}
+		}
+	};
+
+	double StartTime = FPlatformTime::Seconds();
+	ApplyChanges();
+	double UnbatchedTime = FPlatformTime::Seconds() - StartTime;
+	int32 UnbatchedEvents = NumEvents;
+
+	NumEvents = 0;
+	StartTime = FPlatformTime::Seconds();
+	{
+		FRogueAttributeBatchGroup AttributeBatch;
+		ApplyChanges();
+	}
+	double BatchedTime = FPlatformTime::Seconds() - StartTime;
+	int32 BatchedEvents = NumEvents;
+
+	for (int32 i = 0; i < ActionComps.Num(); i++)
+	{
+		ActionComps[i]->GetAttributeListener(SharedGameplayTags::Attribute_Health).Remove(ListenerHandles[i]);
+	}
+
+	UE_LOG(LogTemp, Log, TEXT("Attribute changes, %d components x %d: unbatched %d events %.3f ms, batched %d events %.3f ms"),
+	       ActionComps.Num(), ChangesPerComponent,
+	       UnbatchedEvents, UnbatchedTime * 1000.0,
+	       BatchedEvents, BatchedTime * 1000.0);
+}
+
+static FAutoConsoleCommandWithWorldAndArgs StressAttributeBatchingCommand(TEXT("game.attributes.StressBatching"),
+                                                                          TEXT("Apply [N=20] health changes to every action system component, once unbatched and once in a batch group."),
+                                                                          FConsoleCommandWithWorldAndArgsDelegate::CreateStatic(&StressAttributeBatching));
+#endif
+
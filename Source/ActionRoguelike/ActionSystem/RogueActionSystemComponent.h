@@ -4,13 +4,17 @@
 
 #include "CoreMinimal.h"
 #include "GameplayTagContainer.h"
+#include "RogueGameplayTagMask.h"
 #include "Components/ActorComponent.h"
 #include "RogueActionSystemComponent.generated.h"
 
 struct FRogueAttribute;
+struct FRogueAttributeLayout;
 class URogueAttributeSet;
 class URogueAction;
 
+DECLARE_MULTICAST_DELEGATE_OneParam(FOnActionCooldownFinished, URogueAction* /*Action*/);
+
 DECLARE_MULTICAST_DELEGATE_ThreeParams(FOnAttributeChanged, FGameplayTag /*AttributeTag*/, float /*NewAttributeValue*/,
                                        float /*OldAttributeValue*/);
 
@@ -33,13 +37,40 @@ public:
 	void StopAction(FGameplayTag InActionName);
 	void ApplyAttributeChange(FGameplayTag AttributeTag, float Delta, EAttributeModifyType ModifyType);
 
+	/* Holds back attribute events until the outermost EndAttributeBatch, listeners then receive one old->new event per changed attribute */
+	void BeginAttributeBatch();
+	void EndAttributeBatch();
+
 	FRogueAttribute* GetAttribute(FGameplayTag InAttributeTag);
 
 	virtual void InitializeComponent() override;
 
 	void GrantAction(TSubclassOf<URogueAction> NewActionClass);
+	void RemoveAction(FGameplayTag InActionName);
+
+	URogueAction* FindAction(FGameplayTag InActionName) const;
+
+	/* Collects every granted action whose name matches InParentTag, eg. 'Action.Attack' returns 'Action.Attack.Primary' */
+	void GetActionsMatchingTag(FGameplayTag InParentTag, TArray<URogueAction*>& OutActions) const;
+
+	/* Collects every action that is not running, off cooldown and not blocked in a single pass over the runtime state */
+	void GetStartableActions(TArray<URogueAction*>& OutActions) const;
+
+	bool IsActionRunning(int32 ActionSlot) const
+	{
+		return ActionRunningFlags[ActionSlot];
+	}
+
+	void SetActionRunning(int32 ActionSlot, bool bIsRunning);
+
+	float GetActionCooldownRemaining(int32 ActionSlot) const;
+
+	void StartActionCooldown(int32 ActionSlot, float CooldownTime);
+
+	/* Fires once per action when its cooldown runs out, eg. to refresh ability icons */
+	FOnActionCooldownFinished OnActionCooldownFinished;
 
-	FGameplayTagContainer ActiveGameplayTags;
+	FRogueGameplayTagStack ActiveGameplayTags;
 
 	FOnAttributeChanged& GetAttributeListener(FGameplayTag AttributeTag);
 
@@ -47,19 +78,93 @@ protected:
 	UPROPERTY()
 	TObjectPtr<URogueAttributeSet> Attributes;
 
-	TMap<FGameplayTag, FRogueAttribute*> CachedAttributes;
+	/* Shared per AttributeSetClass, resolves attribute tags to slots without a per-instance map */
+	const FRogueAttributeLayout* AttributeLayout = nullptr;
 
 	UPROPERTY(EditAnywhere, Category=Attributes, NoClear)
 	TSubclassOf<URogueAttributeSet> AttributeSetClass;
 
 	TMap<FGameplayTag, FOnAttributeChanged> AttributeListeners;
 
+	void BroadcastAttributeChanged(FGameplayTag AttributeTag, float NewValue, float OldValue);
+
+	int32 AttributeBatchDepth = 0;
+
+	/* Indexed by AttributeLayout slot, value before the first change of the open batch */
+	TArray<float> BatchedOldValues;
+
+	TBitArray<> BatchedDirtySlots;
+
 	UPROPERTY()
 	TArray<TObjectPtr<URogueAction>> Actions;
 
+	/* Lookup by ActionName, kept in sync with Actions by GrantAction/RemoveAction */
+	TMap<FGameplayTag, URogueAction*> ActionsByName;
+
+	/* Runtime state of each action, parallel to Actions and indexed by URogueAction::GetActionSlot() */
+	TBitArray<> ActionRunningFlags;
+
+	TBitArray<> ActionCoolingDownFlags;
+
+	TArray<float> ActionCooldownUntil;
+
+	TArray<FRogueGameplayTagMask> ActionBlockedTagMasks;
+
+	/* Single timer armed for the earliest pending cooldown instead of one per action */
+	FTimerHandle CooldownTimerHandle;
+
+	void ScheduleCooldownTimer();
+
+	void OnCooldownTimerElapsed();
+
 	UPROPERTY(EditAnywhere, Category="Actions")
 	TArray<TSubclassOf<URogueAction>> DefaultActions;
 
 public:
 	URogueActionSystemComponent();
 };
+
+/* Batches all attribute changes on ActionComp for the lifetime of the scope, eg. while applying a radial hit */
+struct FRogueAttributeBatchScope
+{
+	UE_NONCOPYABLE(FRogueAttributeBatchScope);
+
+	explicit FRogueAttributeBatchScope(URogueActionSystemComponent* InActionComp)
+		: ActionComp(InActionComp)
+	{
+		ActionComp->BeginAttributeBatch();
+	}
+
+	~FRogueAttributeBatchScope()
+	{
+		ActionComp->EndAttributeBatch();
+	}
+
+private:
+	URogueActionSystemComponent* ActionComp;
+};
+
+/* Batches every component whose attributes change while the group is open, eg. all projectile hits of a frame.
+ * Components join on their first change and flush when the group closes, groups may nest on the game thread */
+struct ACTIONROGUELIKE_API FRogueAttributeBatchGroup
+{
+	UE_NONCOPYABLE(FRogueAttributeBatchGroup);
+
+	FRogueAttributeBatchGroup();
+
+	~FRogueAttributeBatchGroup();
+
+	static FRogueAttributeBatchGroup* GetActive()
+	{
+		return Active;
+	}
+
+	void Add(URogueActionSystemComponent* ActionComp);
+
+private:
+	TArray<TWeakObjectPtr<URogueActionSystemComponent>, TInlineAllocator<16>> ActionComps;
+
+	FRogueAttributeBatchGroup* Outer = nullptr;
+
+	static FRogueAttributeBatchGroup* Active;
+};
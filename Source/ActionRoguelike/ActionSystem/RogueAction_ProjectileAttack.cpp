@@ -1,17 +1,22 @@
 ﻿#include "RogueAction_ProjectileAttack.h"
 
-#include "NiagaraFunctionLibrary.h"
 #include "RogueActionSystemComponent.h"
+#include "ActionRoguelike.h"
 #include "RogueGameTypes.h"
+#include "Core/RogueAssetPreloadSubsystem.h"
+#include "Core/RogueEffectSubsystem.h"
 #include "GameFramework/Character.h"
 #include "Kismet/GameplayStatics.h"
 #include "Projectiles/RogueProjectile.h"
+#include "Projectiles/RogueProjectileSubsystem.h"
 
 TAutoConsoleVariable<float> CVarProjectileAdjustmentDebugDrawing(TEXT("game.projectile.DebugDraw"), 0.0f,
                                                                  TEXT(
 	                                                                 "Enable projectile aim adjustment debug rendering. (0 = off, > 0 is duration)"),
                                                                  ECVF_Cheat);
 
+DECLARE_DWORD_COUNTER_STAT(TEXT("Aim Trace Sync Fallbacks"), STAT_AimTraceSyncFallbacks, STATGROUP_ActionRoguelike);
+
 URogueAction_ProjectileAttack::URogueAction_ProjectileAttack()
 {
 	MuzzleSocketName = "Muzzle_01";
@@ -23,58 +28,122 @@ void URogueAction_ProjectileAttack::StartAction_Implementation()
 	
 	URogueActionSystemComponent* ActionComp = GetOwningComponent();
 	ACharacter* Character = CastChecked<ACharacter>(ActionComp->GetOwner());
-	Character->PlayAnimMontage(AttackMontage);
+	Character->PlayAnimMontage(RogueAssets::GetLoaded(AttackMontage));
+
+	GetWorld()->GetSubsystem<URogueEffectSubsystem>()->SpawnEffectAttached(RogueAssets::GetLoaded(CastingEffect),
+	                                                                       Character->GetMesh(), MuzzleSocketName);
+
+	UGameplayStatics::PlaySound2D(this, RogueAssets::GetLoaded(CastingSound));
+
+	// Trace during the attack delay so the result is ready by the time we spawn, async traces from all casters run as one batch
+	Character->GetController()->GetPlayerViewPoint(AimTraceStart, AimRotation);
+	AimTraceEnd = AimTraceStart + (AimRotation.Vector() * AimTraceDistance);
+
+	FCollisionQueryParams QueryParams;
+	QueryParams.AddIgnoredActor(Character);
 
-	UNiagaraFunctionLibrary::SpawnSystemAttached(CastingEffect, Character->GetMesh(), MuzzleSocketName,
-	                                             FVector::ZeroVector, FRotator::ZeroRotator,
-	                                             EAttachLocation::Type::SnapToTarget, true);
+	if (!AimTraceDelegate.IsBound())
+	{
+		AimTraceDelegate.BindUObject(this, &ThisClass::OnAimTraceCompleted);
+	}
 
-	UGameplayStatics::PlaySound2D(this, CastingSound);
+	bAimTraceResolved = false;
+	AimTraceHandle = GetWorld()->AsyncLineTraceByChannel(EAsyncTraceType::Single, AimTraceStart, AimTraceEnd,
+	                                                     COLLISION_PROJECTILE, QueryParams, FCollisionResponseParams::DefaultResponseParam,
+	                                                     &AimTraceDelegate);
 
-	FTimerHandle AttackTimerHandle;
 	const float AttackDelayTime = 0.2f;
 
-	FTimerDelegate Delegate;
 	GetWorld()->GetTimerManager().SetTimer(AttackTimerHandle, this, &ThisClass::AttackTimerElapsed, AttackDelayTime,
 	                                       false);
 }
 
+void URogueAction_ProjectileAttack::OnAimTraceCompleted(const FTraceHandle& TraceHandle, FTraceDatum& TraceData)
+{
+	// A trace from an earlier cast that was stopped before its attack fired
+	if (TraceHandle != AimTraceHandle)
+	{
+		return;
+	}
+
+	bAimTraceResolved = true;
+	AimTraceHitLocation = AimTraceEnd;
+	if (TraceData.OutHits.Num() > 0 && TraceData.OutHits[0].bBlockingHit)
+	{
+		AimTraceHitLocation = TraceData.OutHits[0].Location;
+	}
+}
+
+void URogueAction_ProjectileAttack::StopAction_Implementation()
+{
+	GetWorld()->GetTimerManager().ClearTimer(AttackTimerHandle);
+
+	Super::StopAction_Implementation();
+}
+
+void URogueAction_ProjectileAttack::GetAssetsToPreload(TArray<FSoftObjectPath>& OutAssetPaths) const
+{
+	OutAssetPaths.Add(ProjectileClass.ToSoftObjectPath());
+	OutAssetPaths.Add(CastingEffect.ToSoftObjectPath());
+	OutAssetPaths.Add(AttackMontage.ToSoftObjectPath());
+	OutAssetPaths.Add(CastingSound.ToSoftObjectPath());
+
+	// Projectile effects only become known once its class has streamed in
+	if (UClass* LoadedProjectileClass = ProjectileClass.Get())
+	{
+		LoadedProjectileClass->GetDefaultObject<ARogueProjectile>()->GetAssetsToPreload(OutAssetPaths);
+	}
+}
+
 void URogueAction_ProjectileAttack::AttackTimerElapsed()
 {
 	URogueActionSystemComponent* ActionComp = GetOwningComponent();
 	ACharacter* Character = CastChecked<ACharacter>(ActionComp->GetOwner());
 	FVector SpawnLocation = Character->GetMesh()->GetSocketLocation(MuzzleSocketName);
-	FActorSpawnParameters SpawnParams;
-	SpawnParams.Instigator = Character;
-	SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
-
-	FVector EyeLocation;
-	FRotator EyeRotation;
-	Character->GetController()->GetPlayerViewPoint(EyeLocation, EyeRotation);
 
-	FVector TraceEnd = EyeLocation + (EyeRotation.Vector() * 5000.0f);
+	UWorld* World = GetWorld();
 
-	FCollisionQueryParams QueryParams;
-	QueryParams.AddIgnoredActor(Character);
+	FVector EyeLocation = AimTraceStart;
+	FRotator EyeRotation = AimRotation;
+	FVector TraceEnd = AimTraceEnd;
 
-	UWorld* World = GetWorld();
+	FVector AdjustTargetLocation = TraceEnd;
 
-	FVector AdjustTargetLocation;
-	FHitResult Hit;
-	if (World->LineTraceSingleByChannel(Hit, EyeLocation, TraceEnd, COLLISION_PROJECTILE, QueryParams))
+	if (bAimTraceResolved)
 	{
-		AdjustTargetLocation = Hit.Location;
+		AdjustTargetLocation = AimTraceHitLocation;
 	}
 	else
 	{
+		// Callback hasn't run yet, only when the delay elapsed within the frame the trace was issued in
+		INC_DWORD_STAT(STAT_AimTraceSyncFallbacks);
+
+		Character->GetController()->GetPlayerViewPoint(EyeLocation, EyeRotation);
+		TraceEnd = EyeLocation + (EyeRotation.Vector() * AimTraceDistance);
 		AdjustTargetLocation = TraceEnd;
+
+		FCollisionQueryParams QueryParams;
+		QueryParams.AddIgnoredActor(Character);
+
+		FHitResult Hit;
+		if (World->LineTraceSingleByChannel(Hit, EyeLocation, TraceEnd, COLLISION_PROJECTILE, QueryParams))
+		{
+			AdjustTargetLocation = Hit.Location;
+		}
 	}
+	AimTraceHandle.Invalidate();
+	bAimTraceResolved = false;
 
 	FRotator SpawnRotation = (AdjustTargetLocation - SpawnLocation).Rotation();
 
-	AActor* NewProjectile = World->SpawnActor<AActor>(ProjectileClass, SpawnLocation, SpawnRotation, SpawnParams);
+	URogueProjectileSubsystem* ProjectileSubsystem = World->GetSubsystem<URogueProjectileSubsystem>();
+	AActor* NewProjectile = ProjectileSubsystem->SpawnProjectile(RogueAssets::GetLoaded(ProjectileClass),
+	                                                             FTransform(SpawnRotation, SpawnLocation), Character);
 
-	Character->MoveIgnoreActorAdd(NewProjectile);
+	if (NewProjectile)
+	{
+		Character->MoveIgnoreActorAdd(NewProjectile);
+	}
 
 	StopAction();
 #if !UE_BUILD_SHIPPING
@@ -91,7 +160,7 @@ void URogueAction_ProjectileAttack::AttackTimerElapsed()
 		DrawDebugLine(World, SpawnLocation, AdjustTargetLocation, FColor::Yellow, false, DebugDrawDuration);
 
 		// the original path of the projectile
-		DrawDebugLine(World, SpawnLocation, SpawnLocation + (EyeRotation.Vector() * 5000.0f), FColor::Purple,
+		DrawDebugLine(World, SpawnLocation, SpawnLocation + (EyeRotation.Vector() * AimTraceDistance), FColor::Purple,
 					  false, DebugDrawDuration);
 	}
 #endif
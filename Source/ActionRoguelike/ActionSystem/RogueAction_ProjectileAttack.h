@@ -4,6 +4,7 @@
 
 #include "CoreMinimal.h"
 #include "RogueAction.h"
+#include "WorldCollision.h"
 #include "RogueAction_ProjectileAttack.generated.h"
 
 class URogueActionSystemComponent;
@@ -21,24 +22,54 @@ class ACTIONROGUELIKE_API URogueAction_ProjectileAttack : public URogueAction
 	GENERATED_BODY()
 
 	virtual void StartAction_Implementation() override;
+
+	virtual void StopAction_Implementation() override;
+
+	virtual void GetAssetsToPreload(TArray<FSoftObjectPath>& OutAssetPaths) const override;
 	
 	void AttackTimerElapsed();
+
+	/* Cleared when the action stops early or is removed, so the attack never fires for a stopped action */
+	FTimerHandle AttackTimerHandle;
+
+	void OnAimTraceCompleted(const FTraceHandle& TraceHandle, FTraceDatum& TraceData);
+
+	/* Aim correction trace, issued async in StartAction. The world only keeps async results for one frame,
+	 * so the callback stores the outcome until the attack delay has passed */
+	FTraceHandle AimTraceHandle;
+
+	FTraceDelegate AimTraceDelegate;
+
+	bool bAimTraceResolved = false;
+
+	/* Blocking hit of the resolved trace, AimTraceEnd if nothing was hit */
+	FVector AimTraceHitLocation;
+
+	FVector AimTraceStart;
+
+	FVector AimTraceEnd;
+
+	FRotator AimRotation;
 protected:
+	/* Soft referenced, streamed in by URogueAssetPreloadSubsystem when the action is granted */
 	UPROPERTY(EditDefaultsOnly, Category="ProjectileAttack")
-	TSubclassOf<ARogueProjectile> ProjectileClass;
+	TSoftClassPtr<ARogueProjectile> ProjectileClass;
 	
 	UPROPERTY(EditDefaultsOnly, Category="ProjectileAttack")
-	TObjectPtr<UNiagaraSystem> CastingEffect;
+	TSoftObjectPtr<UNiagaraSystem> CastingEffect;
 
 	UPROPERTY(EditDefaultsOnly, Category="ProjectileAttack")
-	TObjectPtr<UAnimMontage> AttackMontage;
+	TSoftObjectPtr<UAnimMontage> AttackMontage;
 
 	UPROPERTY(EditDefaultsOnly, Category="ProjectileAttack")
-	TObjectPtr<USoundBase> CastingSound;
+	TSoftObjectPtr<USoundBase> CastingSound;
 
 	UPROPERTY(VisibleAnywhere, Category="ProjectileAttack")
 	FName MuzzleSocketName;
 
+	UPROPERTY(EditDefaultsOnly, Category="ProjectileAttack")
+	float AimTraceDistance = 5000.0f;
+
 public:
 	URogueAction_ProjectileAttack();
 };
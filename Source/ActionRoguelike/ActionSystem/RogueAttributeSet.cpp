@@ -1,5 +1,39 @@
 ﻿#include "RogueAttributeSet.h"
 
+#include "UObject/ObjectKey.h"
+
+
+const FRogueAttributeLayout& FRogueAttributeLayout::Get(const UClass* AttributeSetClass)
+{
+	check(IsInGameThread());
+
+	// Keyed by TObjectKey so a recompiled Blueprint class never picks up the layout of a stale class at the same address
+	static TMap<TObjectKey<UClass>, TUniquePtr<FRogueAttributeLayout>> LayoutsByClass;
+
+	TUniquePtr<FRogueAttributeLayout>& Layout = LayoutsByClass.FindOrAdd(AttributeSetClass);
+	if (!Layout.IsValid())
+	{
+		Layout = MakeUnique<FRogueAttributeLayout>();
+
+		for (TFieldIterator<FStructProperty> PropIt(AttributeSetClass); PropIt; ++PropIt)
+		{
+			if (PropIt->Struct != FRogueAttribute::StaticStruct())
+			{
+				continue;
+			}
+
+			FName AttributeTagName = FName("Attribute." + PropIt->GetName());
+			FGameplayTag AttributeTag = FGameplayTag::RequestGameplayTag(AttributeTagName);
+
+			int32 Slot = Layout->Offsets.Add(PropIt->GetOffset_ForInternal());
+			Layout->Tags.Add(AttributeTag);
+			Layout->SlotsByTag.Add(AttributeTag, Slot);
+		}
+	}
+
+	return *Layout;
+}
+
 
 URogueHealthAttributeSet::URogueHealthAttributeSet()
 {
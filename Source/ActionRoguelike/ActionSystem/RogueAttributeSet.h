@@ -3,6 +3,7 @@
 #pragma once
 
 #include "CoreMinimal.h"
+#include "GameplayTagContainer.h"
 #include "UObject/Object.h"
 #include "RogueAttributeSet.generated.h"
 
@@ -27,12 +28,42 @@ struct FRogueAttribute
 	}
 };
 
+/* Tag to slot table for one AttributeSet class, built once on first use and shared by all instances of that class */
+struct ACTIONROGUELIKE_API FRogueAttributeLayout
+{
+	/* Index into Offsets/Tags, INDEX_NONE when the class has no such attribute */
+	int32 FindSlot(FGameplayTag InAttributeTag) const
+	{
+		const int32* Slot = SlotsByTag.Find(InAttributeTag);
+		return Slot ? *Slot : INDEX_NONE;
+	}
+
+	int32 Num() const
+	{
+		return Offsets.Num();
+	}
+
+	static const FRogueAttributeLayout& Get(const UClass* AttributeSetClass);
+
+	TMap<FGameplayTag, int32> SlotsByTag;
+
+	/* Byte offset of each FRogueAttribute inside the AttributeSet */
+	TArray<int32> Offsets;
+
+	TArray<FGameplayTag> Tags;
+};
+
 UCLASS()
 class ACTIONROGUELIKE_API URogueAttributeSet : public UObject
 {
 	GENERATED_BODY()
 public:
 	virtual void PostAttributeChanged() {};
+
+	FRogueAttribute* GetAttributeAt(const FRogueAttributeLayout& Layout, int32 Slot)
+	{
+		return reinterpret_cast<FRogueAttribute*>(reinterpret_cast<uint8*>(this) + Layout.Offsets[Slot]);
+	}
 };
 
 UCLASS()
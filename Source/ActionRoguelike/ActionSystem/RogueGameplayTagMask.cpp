@@ -0,0 +1,129 @@
+﻿#include "RogueGameplayTagMask.h"
+
+#include "GameplayTagsManager.h"
+
+
+int32 FRogueGameplayTagMask::GetTagIndex(FGameplayTag InTag)
+{
+	check(IsInGameThread());
+
+	// Built on first use, by then all native and config tags have been registered
+	static TMap<FGameplayTag, int32> TagIndices;
+	if (TagIndices.IsEmpty())
+	{
+		FGameplayTagContainer AllTags;
+		UGameplayTagsManager::Get().RequestAllGameplayTags(AllTags, false);
+
+		TagIndices.Reserve(AllTags.Num());
+		for (const FGameplayTag& Tag : AllTags)
+		{
+			TagIndices.Add(Tag, TagIndices.Num());
+		}
+	}
+
+	if (const int32* Index = TagIndices.Find(InTag))
+	{
+		return *Index;
+	}
+
+	// Registered later, eg. by a plugin. Appending keeps the bits of all existing masks valid
+	if (InTag.IsValid() && UGameplayTagsManager::Get().RequestGameplayTag(InTag.GetTagName(), false).IsValid())
+	{
+		return TagIndices.Add(InTag, TagIndices.Num());
+	}
+
+	return INDEX_NONE;
+}
+
+FRogueGameplayTagMask FRogueGameplayTagMask::FromContainer(const FGameplayTagContainer& Container, bool bIncludeParents)
+{
+	FRogueGameplayTagMask Mask;
+
+	FGameplayTagContainer Tags = bIncludeParents ? Container.GetGameplayTagParents() : Container;
+	for (const FGameplayTag& Tag : Tags)
+	{
+		int32 Index = GetTagIndex(Tag);
+		if (Index != INDEX_NONE)
+		{
+			Mask.SetBit(Index);
+		}
+		else
+		{
+			Mask.UnindexedTags.AddTagFast(Tag);
+		}
+	}
+
+	return Mask;
+}
+
+
+void FRogueGameplayTagStack::AddTags(const FRogueGameplayTagMask& InMask)
+{
+	if (InMask.Words.Num() > ActiveMask.Words.Num())
+	{
+		ActiveMask.Words.SetNumZeroed(InMask.Words.Num());
+		TagCounts.SetNumZeroed(InMask.Words.Num() * 64);
+	}
+
+	for (int32 Word = 0; Word < InMask.Words.Num(); Word++)
+	{
+		uint64 Bits = InMask.Words[Word];
+		while (Bits != 0)
+		{
+			int32 Index = (Word << 6) + FMath::CountTrailingZeros64(Bits);
+			Bits &= Bits - 1;
+
+			TagCounts[Index]++;
+		}
+
+		ActiveMask.Words[Word] |= InMask.Words[Word];
+	}
+
+	for (const FGameplayTag& Tag : InMask.UnindexedTags)
+	{
+		if (UnindexedTagCounts.FindOrAdd(Tag)++ == 0)
+		{
+			ActiveMask.UnindexedTags.AddTagFast(Tag);
+		}
+	}
+}
+
+void FRogueGameplayTagStack::RemoveTags(const FRogueGameplayTagMask& InMask)
+{
+	// Only ever removes what AddTags added, so TagCounts already covers every word of InMask
+	for (int32 Word = 0; Word < InMask.Words.Num(); Word++)
+	{
+		uint64 Bits = InMask.Words[Word];
+		while (Bits != 0)
+		{
+			int32 Index = (Word << 6) + FMath::CountTrailingZeros64(Bits);
+			Bits &= Bits - 1;
+
+			if (ensure(TagCounts[Index] > 0) && --TagCounts[Index] == 0)
+			{
+				ActiveMask.ClearBit(Index);
+			}
+		}
+	}
+
+	for (const FGameplayTag& Tag : InMask.UnindexedTags)
+	{
+		uint16* Count = UnindexedTagCounts.Find(Tag);
+		if (ensure(Count && *Count > 0) && --(*Count) == 0)
+		{
+			UnindexedTagCounts.Remove(Tag);
+			ActiveMask.UnindexedTags.RemoveTag(Tag);
+		}
+	}
+}
+
+bool FRogueGameplayTagStack::HasTag(FGameplayTag InTag) const
+{
+	int32 Index = FRogueGameplayTagMask::GetTagIndex(InTag);
+	if (Index == INDEX_NONE)
+	{
+		return ActiveMask.UnindexedTags.HasTagExact(InTag);
+	}
+
+	return ActiveMask.HasBit(Index);
+}
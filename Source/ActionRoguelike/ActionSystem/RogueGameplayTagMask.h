@@ -0,0 +1,105 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameplayTagContainer.h"
+
+/* Bit set over all registered gameplay tags, one bit per tag. Replaces container scans for action gating.
+ * Grows with the tag table, words past the end of a shorter mask count as zero */
+struct ACTIONROGUELIKE_API FRogueGameplayTagMask
+{
+	/* Masks up to this many tags never allocate */
+	static constexpr int32 NumInlineWords = 4;
+
+	/* bIncludeParents also sets the parents of each tag, required for active tags so they match a query on 'StatusEffect' */
+	static FRogueGameplayTagMask FromContainer(const FGameplayTagContainer& Container, bool bIncludeParents);
+
+	/* Bit of InTag in the project wide tag table, tags registered after the table was built are appended on first use.
+	 * INDEX_NONE if the tag is not registered at all */
+	static int32 GetTagIndex(FGameplayTag InTag);
+
+	void SetBit(int32 Index)
+	{
+		int32 Word = Index >> 6;
+		if (Word >= Words.Num())
+		{
+			Words.SetNumZeroed(Word + 1);
+		}
+		Words[Word] |= (1ull << (Index & 63));
+	}
+
+	void ClearBit(int32 Index)
+	{
+		int32 Word = Index >> 6;
+		if (Word < Words.Num())
+		{
+			Words[Word] &= ~(1ull << (Index & 63));
+		}
+	}
+
+	bool HasBit(int32 Index) const
+	{
+		int32 Word = Index >> 6;
+		return Word < Words.Num() && (Words[Word] & (1ull << (Index & 63))) != 0;
+	}
+
+	bool HasAny(const FRogueGameplayTagMask& Other) const
+	{
+		uint64 Overlap = 0;
+		const int32 NumWords = FMath::Min(Words.Num(), Other.Words.Num());
+		for (int32 i = 0; i < NumWords; i++)
+		{
+			Overlap |= Words[i] & Other.Words[i];
+		}
+		if (Overlap != 0)
+		{
+			return true;
+		}
+
+		return !UnindexedTags.IsEmpty() && UnindexedTags.HasAnyExact(Other.UnindexedTags);
+	}
+
+	bool IsEmpty() const
+	{
+		uint64 Combined = 0;
+		for (uint64 Word : Words)
+		{
+			Combined |= Word;
+		}
+		return Combined == 0 && UnindexedTags.IsEmpty();
+	}
+
+	TArray<uint64, TInlineAllocator<NumInlineWords>> Words;
+
+	/* Tags without a bit, matched exactly through the container instead of being dropped */
+	FGameplayTagContainer UnindexedTags;
+};
+
+/* Reference counted set of active tags, a tag granted by two running actions stays active until both have stopped */
+struct ACTIONROGUELIKE_API FRogueGameplayTagStack
+{
+	void AddTags(const FRogueGameplayTagMask& InMask);
+	void RemoveTags(const FRogueGameplayTagMask& InMask);
+
+	bool HasAny(const FRogueGameplayTagMask& InMask) const
+	{
+		return ActiveMask.HasAny(InMask);
+	}
+
+	/* Matches parents as well, eg. 'StatusEffect' is true while 'StatusEffect.Sprinting' is active */
+	bool HasTag(FGameplayTag InTag) const;
+
+	const FRogueGameplayTagMask& GetMask() const
+	{
+		return ActiveMask;
+	}
+
+private:
+	FRogueGameplayTagMask ActiveMask;
+
+	/* Indexed by tag bit, grows with the widest mask added */
+	TArray<uint16, TInlineAllocator<FRogueGameplayTagMask::NumInlineWords * 64>> TagCounts;
+
+	TMap<FGameplayTag, uint16> UnindexedTagCounts;
+};
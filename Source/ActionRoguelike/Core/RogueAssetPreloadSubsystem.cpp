@@ -0,0 +1,147 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "RogueAssetPreloadSubsystem.h"
+
+#include "ActionRoguelike.h"
+#include "ActionSystem/RogueAction.h"
+
+static FAutoConsoleCommandWithWorld LogPreloadsCommand(TEXT("game.assets.LogPreloads"),
+                                                       TEXT("Log streaming time and memory of all preloaded action assets."),
+                                                       FConsoleCommandWithWorldDelegate::CreateLambda([](UWorld* World)
+                                                       {
+	                                                       if (URogueAssetPreloadSubsystem* Subsystem = World->GetSubsystem<URogueAssetPreloadSubsystem>())
+	                                                       {
+		                                                       Subsystem->LogPreloads();
+	                                                       }
+                                                       }));
+
+DECLARE_DWORD_COUNTER_STAT(TEXT("Asset Preload Stalls"), STAT_AssetPreloadStalls, STATGROUP_ActionRoguelike);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Preloaded Asset Memory (KB)"), STAT_PreloadedAssetMemory, STATGROUP_ActionRoguelike);
+
+/* Stalls can happen anywhere an asset is used, outside of any world */
+static int32 GNumPreloadStalls = 0;
+static double GPreloadStallSeconds = 0.0;
+
+/* Soft references are discovered by loading their owners, this bounds the depth of that chain */
+static constexpr int32 MaxPreloadRounds = 4;
+
+
+void URogueAssetPreloadSubsystem::PreloadAction(URogueAction* Action)
+{
+	TObjectKey<UClass> ActionClass(Action->GetClass());
+	if (PreloadsByActionClass.Contains(ActionClass))
+	{
+		return;
+	}
+
+	FRogueActionPreload& Preload = PreloadsByActionClass.Add(ActionClass);
+	Preload.RequestTime = FPlatformTime::Seconds();
+
+	RequestPreloadRound(ActionClass, Action);
+}
+
+void URogueAssetPreloadSubsystem::RequestPreloadRound(TObjectKey<UClass> ActionClass,
+                                                      TWeakObjectPtr<URogueAction> WeakAction)
+{
+	FRogueActionPreload* Preload = PreloadsByActionClass.Find(ActionClass);
+	if (Preload == nullptr)
+	{
+		return;
+	}
+
+	URogueAction* Action = WeakAction.Get();
+	if (Action == nullptr || Preload->Handles.Num() >= MaxPreloadRounds)
+	{
+		CompletePreload(ActionClass, *Preload);
+		return;
+	}
+
+	TArray<FSoftObjectPath> AssetPaths;
+	Action->GetAssetsToPreload(AssetPaths);
+
+	// Anything already in memory is either hard referenced elsewhere or was streamed in a previous round
+	AssetPaths.RemoveAll([](const FSoftObjectPath& AssetPath)
+	{
+		return AssetPath.IsNull() || AssetPath.ResolveObject() != nullptr;
+	});
+
+	if (AssetPaths.IsEmpty())
+	{
+		CompletePreload(ActionClass, *Preload);
+		return;
+	}
+
+	Preload->Handles.Add(StreamableManager.RequestAsyncLoad(MoveTemp(AssetPaths),
+		FStreamableDelegate::CreateUObject(this, &ThisClass::RequestPreloadRound, ActionClass, WeakAction)));
+}
+
+void URogueAssetPreloadSubsystem::CompletePreload(TObjectKey<UClass> ActionClass, FRogueActionPreload& Preload)
+{
+	Preload.CompletedTime = FPlatformTime::Seconds();
+
+	for (const TSharedPtr<FStreamableHandle>& Handle : Preload.Handles)
+	{
+		TArray<UObject*> LoadedAssets;
+		Handle->GetLoadedAssets(LoadedAssets);
+
+		for (UObject* LoadedAsset : LoadedAssets)
+		{
+			Preload.NumAssets++;
+			Preload.ResourceSizeBytes += LoadedAsset->GetResourceSizeBytes(EResourceSizeMode::Exclusive);
+		}
+	}
+
+	INC_DWORD_STAT_BY(STAT_PreloadedAssetMemory, Preload.ResourceSizeBytes / 1024);
+
+	UE_LOG(LogTemp, Log, TEXT("Preloaded %d assets (%.1f KB) for %s in %.2f ms"),
+	       Preload.NumAssets,
+	       Preload.ResourceSizeBytes / 1024.0,
+	       *GetNameSafe(ActionClass.ResolveObjectPtr()),
+	       (Preload.CompletedTime - Preload.RequestTime) * 1000.0);
+}
+
+void URogueAssetPreloadSubsystem::RecordPreloadStall(const FSoftObjectPath& AssetPath, double StallSeconds)
+{
+	GNumPreloadStalls++;
+	GPreloadStallSeconds += StallSeconds;
+	INC_DWORD_STAT(STAT_AssetPreloadStalls);
+
+	UE_LOG(LogTemp, Warning, TEXT("Asset %s was used before it finished preloading, loading took %.2f ms"),
+	       *AssetPath.ToString(),
+	       StallSeconds * 1000.0);
+}
+
+void URogueAssetPreloadSubsystem::LogPreloads() const
+{
+	int64 TotalBytes = 0;
+	for (const TPair<TObjectKey<UClass>, FRogueActionPreload>& Pair : PreloadsByActionClass)
+	{
+		const FRogueActionPreload& Preload = Pair.Value;
+		TotalBytes += Preload.ResourceSizeBytes;
+
+		if (Preload.CompletedTime > 0.0)
+		{
+			UE_LOG(LogTemp, Log, TEXT("  %s: %d assets, %.1f KB, streamed in %.2f ms"),
+			       *GetNameSafe(Pair.Key.ResolveObjectPtr()),
+			       Preload.NumAssets,
+			       Preload.ResourceSizeBytes / 1024.0,
+			       (Preload.CompletedTime - Preload.RequestTime) * 1000.0);
+		}
+		else
+		{
+			UE_LOG(LogTemp, Log, TEXT("  %s: streaming"), *GetNameSafe(Pair.Key.ResolveObjectPtr()));
+		}
+	}
+
+	UE_LOG(LogTemp, Log, TEXT("Preloads: %d actions, %.1f KB deferred from character load, %d first use stalls (%.2f ms total)"),
+	       PreloadsByActionClass.Num(),
+	       TotalBytes / 1024.0,
+	       GNumPreloadStalls,
+	       GPreloadStallSeconds * 1000.0);
+}
+
+bool URogueAssetPreloadSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
@@ -0,0 +1,96 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/StreamableManager.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "RogueAssetPreloadSubsystem.generated.h"
+
+class URogueAction;
+
+struct FRogueActionPreload
+{
+	/* Keeps the streamed assets loaded, one handle per round of discovered soft references */
+	TArray<TSharedPtr<FStreamableHandle>> Handles;
+
+	double RequestTime = 0.0;
+
+	/* Zero while still streaming */
+	double CompletedTime = 0.0;
+
+	int32 NumAssets = 0;
+
+	/* Memory that is no longer loaded together with the Blueprints referencing these assets */
+	int64 ResourceSizeBytes = 0;
+};
+
+/* Streams the soft referenced assets of actions in the background as soon as they are granted */
+UCLASS()
+class ACTIONROGUELIKE_API URogueAssetPreloadSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	/* Shared by all instances of the action class, only the first grant starts streaming */
+	void PreloadAction(URogueAction* Action);
+
+	void LogPreloads() const;
+
+	/* An asset was used before its preload finished and had to be loaded on the spot */
+	static void RecordPreloadStall(const FSoftObjectPath& AssetPath, double StallSeconds);
+
+protected:
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+	/* Requests everything the action reports that is not loaded yet, newly loaded assets may expose further soft references */
+	void RequestPreloadRound(TObjectKey<UClass> ActionClass, TWeakObjectPtr<URogueAction> WeakAction);
+
+	void CompletePreload(TObjectKey<UClass> ActionClass, FRogueActionPreload& Preload);
+
+	FStreamableManager StreamableManager;
+
+	TMap<TObjectKey<UClass>, FRogueActionPreload> PreloadsByActionClass;
+};
+
+namespace RogueAssets
+{
+	/* The preloaded asset, falls back to a synchronous load when streaming has not finished yet */
+	template <typename T>
+	T* GetLoaded(const TSoftObjectPtr<T>& InAsset)
+	{
+		if (T* LoadedAsset = InAsset.Get())
+		{
+			return LoadedAsset;
+		}
+
+		if (InAsset.IsNull())
+		{
+			return nullptr;
+		}
+
+		double StartTime = FPlatformTime::Seconds();
+		T* LoadedAsset = InAsset.LoadSynchronous();
+		URogueAssetPreloadSubsystem::RecordPreloadStall(InAsset.ToSoftObjectPath(), FPlatformTime::Seconds() - StartTime);
+		return LoadedAsset;
+	}
+
+	template <typename T>
+	TSubclassOf<T> GetLoaded(const TSoftClassPtr<T>& InClass)
+	{
+		if (UClass* LoadedClass = InClass.Get())
+		{
+			return LoadedClass;
+		}
+
+		if (InClass.IsNull())
+		{
+			return nullptr;
+		}
+
+		double StartTime = FPlatformTime::Seconds();
+		UClass* LoadedClass = InClass.LoadSynchronous();
+		URogueAssetPreloadSubsystem::RecordPreloadStall(InClass.ToSoftObjectPath(), FPlatformTime::Seconds() - StartTime);
+		return LoadedClass;
+	}
+}
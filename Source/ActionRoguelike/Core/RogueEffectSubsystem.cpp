@@ -0,0 +1,149 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "RogueEffectSubsystem.h"
+
+#include "ActionRoguelike.h"
+#include "NiagaraComponent.h"
+#include "NiagaraFunctionLibrary.h"
+#include "Kismet/GameplayStatics.h"
+#include "Sound/SoundConcurrency.h"
+
+DECLARE_CYCLE_STAT(TEXT("Dispatch Effects"), STAT_DispatchEffects, STATGROUP_ActionRoguelike);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Effects Requested"), STAT_EffectsRequested, STATGROUP_ActionRoguelike);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Effects Spawned"), STAT_EffectsSpawned, STATGROUP_ActionRoguelike);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Sounds Requested"), STAT_SoundsRequested, STATGROUP_ActionRoguelike);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Sounds Played"), STAT_SoundsPlayed, STATGROUP_ActionRoguelike);
+
+
+void URogueEffectSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	SoundConcurrency = NewObject<USoundConcurrency>(this);
+	SoundConcurrency->Concurrency.MaxCount = MaxConcurrentSounds;
+	SoundConcurrency->Concurrency.bLimitToOwner = false;
+	SoundConcurrency->Concurrency.ResolutionRule = EMaxConcurrentResolutionRule::StopFarthestThenOldest;
+}
+
+void URogueEffectSubsystem::PlayEffectAtLocation(UNiagaraSystem* InEffect, const FVector& InLocation,
+                                                 const FRotator& InRotation)
+{
+	if (InEffect)
+	{
+		QueuedEffects.Add({InEffect, InLocation, InRotation});
+		INC_DWORD_STAT(STAT_EffectsRequested);
+	}
+}
+
+void URogueEffectSubsystem::PlaySoundAtLocation(USoundBase* InSound, const FVector& InLocation)
+{
+	if (InSound)
+	{
+		QueuedSounds.Add({InSound, InLocation});
+		INC_DWORD_STAT(STAT_SoundsRequested);
+	}
+}
+
+UNiagaraComponent* URogueEffectSubsystem::SpawnEffectAttached(UNiagaraSystem* InEffect,
+                                                              USceneComponent* AttachToComponent,
+                                                              FName AttachPointName, bool bManualRelease)
+{
+	return UNiagaraFunctionLibrary::SpawnSystemAttached(InEffect, AttachToComponent, AttachPointName,
+	                                                    FVector::ZeroVector, FRotator::ZeroRotator,
+	                                                    EAttachLocation::Type::SnapToTarget, false, true,
+	                                                    bManualRelease ? ENCPoolMethod::ManualRelease : ENCPoolMethod::AutoRelease);
+}
+
+void URogueEffectSubsystem::Tick(float DeltaTime)
+{
+	if (QueuedEffects.IsEmpty() && QueuedSounds.IsEmpty())
+	{
+		return;
+	}
+
+	SCOPE_CYCLE_COUNTER(STAT_DispatchEffects);
+
+	UWorld* World = GetWorld();
+
+	FVector ViewLocation = FVector::ZeroVector;
+	APlayerController* PC = World->GetFirstPlayerController();
+	if (PC && PC->PlayerCameraManager)
+	{
+		ViewLocation = PC->PlayerCameraManager->GetCameraLocation();
+	}
+
+	CullQueuedEffects(QueuedEffects, ViewLocation, MaxEffectsPerFrame);
+	for (const FRogueQueuedEffect& Effect : QueuedEffects)
+	{
+		UNiagaraFunctionLibrary::SpawnSystemAtLocation(World, CastChecked<UNiagaraSystem>(Effect.Asset), Effect.Location,
+		                                               Effect.Rotation, FVector(1.f), true, true,
+		                                               ENCPoolMethod::AutoRelease);
+	}
+	INC_DWORD_STAT_BY(STAT_EffectsSpawned, QueuedEffects.Num());
+
+	CullQueuedEffects(QueuedSounds, ViewLocation, MaxSoundsPerFrame);
+	for (const FRogueQueuedEffect& Sound : QueuedSounds)
+	{
+		UGameplayStatics::PlaySoundAtLocation(World, CastChecked<USoundBase>(Sound.Asset), Sound.Location,
+		                                      FRotator::ZeroRotator, 1.f, 1.f, 0.f, nullptr, SoundConcurrency);
+	}
+	INC_DWORD_STAT_BY(STAT_SoundsPlayed, QueuedSounds.Num());
+
+	QueuedEffects.Reset();
+	QueuedSounds.Reset();
+}
+
+void URogueEffectSubsystem::CullQueuedEffects(TArray<FRogueQueuedEffect>& InOutQueued, const FVector& ViewLocation,
+                                              int32 Budget) const
+{
+	double MaxDistanceSquared = FMath::Square((double)MaxEffectDistance);
+
+	TSet<TPair<UObject*, FIntVector>> OccupiedCells;
+	OccupiedCells.Reserve(InOutQueued.Num());
+
+	// Compact in place, keeping the first request of every asset per cell
+	int32 NumKept = 0;
+	for (int32 i = 0; i < InOutQueued.Num(); i++)
+	{
+		FRogueQueuedEffect& Effect = InOutQueued[i];
+		Effect.DistanceSquared = FVector::DistSquared(Effect.Location, ViewLocation);
+		if (Effect.DistanceSquared > MaxDistanceSquared)
+		{
+			continue;
+		}
+
+		FIntVector Cell(FMath::FloorToInt32(Effect.Location.X / CellSize),
+		                FMath::FloorToInt32(Effect.Location.Y / CellSize),
+		                FMath::FloorToInt32(Effect.Location.Z / CellSize));
+
+		bool bAlreadyInCell = false;
+		OccupiedCells.Add(TPair<UObject*, FIntVector>(Effect.Asset, Cell), &bAlreadyInCell);
+		if (bAlreadyInCell)
+		{
+			continue;
+		}
+
+		InOutQueued[NumKept++] = Effect;
+	}
+	InOutQueued.SetNum(NumKept, EAllowShrinking::No);
+
+	if (InOutQueued.Num() > Budget)
+	{
+		InOutQueued.Sort([](const FRogueQueuedEffect& A, const FRogueQueuedEffect& B)
+		{
+			return A.DistanceSquared < B.DistanceSquared;
+		});
+		InOutQueued.SetNum(Budget, EAllowShrinking::No);
+	}
+}
+
+TStatId URogueEffectSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(URogueEffectSubsystem, STATGROUP_Tickables);
+}
+
+bool URogueEffectSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
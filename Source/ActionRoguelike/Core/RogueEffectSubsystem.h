@@ -0,0 +1,84 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "RogueEffectSubsystem.generated.h"
+
+class UNiagaraComponent;
+class UNiagaraSystem;
+class USoundBase;
+class USoundConcurrency;
+
+/* One-shot effect or sound waiting for the end of the frame */
+USTRUCT()
+struct FRogueQueuedEffect
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	TObjectPtr<UObject> Asset = nullptr;
+
+	FVector Location = FVector::ZeroVector;
+
+	FRotator Rotation = FRotator::ZeroRotator;
+
+	/* To the local player view, filled during dispatch */
+	double DistanceSquared = 0.0;
+};
+
+/* Central dispatch for gameplay effects. One-shots are gathered during the frame, identical ones within the same cell
+ * are collapsed, then culled by distance and a per frame budget before spawning from the Niagara component pool */
+UCLASS(Config=Game)
+class ACTIONROGUELIKE_API URogueEffectSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	void PlayEffectAtLocation(UNiagaraSystem* InEffect, const FVector& InLocation,
+	                          const FRotator& InRotation = FRotator::ZeroRotator);
+
+	void PlaySoundAtLocation(USoundBase* InSound, const FVector& InLocation);
+
+	/* Spawned right away from the pool, AutoRelease returns it once complete, ManualRelease expects a call to ReleaseToPool() */
+	UNiagaraComponent* SpawnEffectAttached(UNiagaraSystem* InEffect, USceneComponent* AttachToComponent,
+	                                       FName AttachPointName, bool bManualRelease = false);
+
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+
+	virtual void Tick(float DeltaTime) override;
+
+	virtual TStatId GetStatId() const override;
+
+protected:
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+	/* Collapses duplicates per cell, drops anything beyond MaxDistance and keeps the closest up to Budget */
+	void CullQueuedEffects(TArray<FRogueQueuedEffect>& InOutQueued, const FVector& ViewLocation, int32 Budget) const;
+
+	UPROPERTY(Config)
+	float CellSize = 100.0f;
+
+	UPROPERTY(Config)
+	float MaxEffectDistance = 10000.0f;
+
+	UPROPERTY(Config)
+	int32 MaxEffectsPerFrame = 16;
+
+	UPROPERTY(Config)
+	int32 MaxSoundsPerFrame = 8;
+
+	/* Applies to all one-shot sounds played through the subsystem, the farthest then oldest are stopped beyond this */
+	UPROPERTY(Config)
+	int32 MaxConcurrentSounds = 16;
+
+	UPROPERTY()
+	TObjectPtr<USoundConcurrency> SoundConcurrency;
+
+	UPROPERTY()
+	TArray<FRogueQueuedEffect> QueuedEffects;
+
+	UPROPERTY()
+	TArray<FRogueQueuedEffect> QueuedSounds;
+};
@@ -3,9 +3,320 @@
 
 #include "RogueGameMode.h"
 
+#include "ActionRoguelike.h"
+#include "AIController.h"
+#include "BrainComponent.h"
+#include "SharedGameplayTags.h"
+#include "ActionSystem/RogueActionSystemComponent.h"
+#include "ActionSystem/RogueAttributeSet.h"
+#include "AI/RogueAICharacter.h"
+#include "Components/CapsuleComponent.h"
+#include "EnvironmentQuery/EnvQueryManager.h"
+#include "GameFramework/CharacterMovementComponent.h"
 #include "Player/RoguePlayerController.h"
 
+TAutoConsoleVariable<bool> CVarDirectorEnabled(TEXT("game.director.Enabled"), true,
+                                               TEXT("Spawn minion waves from the game mode director. (0 = Off, 1 = enabled)"),
+                                               ECVF_Cheat);
+
+static FAutoConsoleCommandWithWorld LogDirectorStatsCommand(TEXT("game.director.LogStats"),
+                                                            TEXT("Log spawn latency and minion pool occupancy of the director."),
+                                                            FConsoleCommandWithWorldDelegate::CreateLambda([](UWorld* World)
+                                                            {
+	                                                            if (ARogueGameMode* GameMode = World->GetAuthGameMode<ARogueGameMode>())
+	                                                            {
+		                                                            GameMode->LogDirectorStats();
+	                                                            }
+                                                            }));
+
+DECLARE_CYCLE_STAT(TEXT("Director Spawn Minions"), STAT_DirectorSpawnMinions, STATGROUP_ActionRoguelike);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Alive Minions"), STAT_AliveMinions, STATGROUP_ActionRoguelike);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Pooled Minions"), STAT_PooledMinions, STATGROUP_ActionRoguelike);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Queued Minion Spawns"), STAT_QueuedMinionSpawns, STATGROUP_ActionRoguelike);
+DECLARE_FLOAT_ACCUMULATOR_STAT(TEXT("Last Minion Spawn Latency (ms)"), STAT_MinionSpawnLatency, STATGROUP_ActionRoguelike);
+
+
 ARogueGameMode::ARogueGameMode()
 {
 	PlayerControllerClass = ARoguePlayerController::StaticClass();
+
+	PrimaryActorTick.bCanEverTick = true;
+}
+
+void ARogueGameMode::StartPlay()
+{
+	Super::StartPlay();
+
+	for (const FRogueMinionSpawnInfo& SpawnInfo : MinionTypes)
+	{
+		if (!ensure(SpawnInfo.MinionClass))
+		{
+			continue;
+		}
+
+		MinionPools.FindOrAdd(SpawnInfo.MinionClass);
+		for (int32 i = 0; i < SpawnInfo.PrewarmCount; i++)
+		{
+			if (ARogueAICharacter* Minion = SpawnMinion(SpawnInfo.MinionClass, GetActorLocation()))
+			{
+				ReleaseMinion(Minion);
+			}
+		}
+	}
+
+	if (SpawnPointQuery && MinionTypes.Num() > 0)
+	{
+		GetWorldTimerManager().SetTimer(SpawnQueryTimerHandle, this, &ThisClass::RunSpawnQuery, SpawnQueryInterval, true);
+	}
+}
+
+void ARogueGameMode::Tick(float DeltaSeconds)
+{
+	Super::Tick(DeltaSeconds);
+
+	Credits = FMath::Min(Credits + CreditsPerSecond * DeltaSeconds, MaxCredits);
+
+	ProcessQueuedSpawns();
+}
+
+void ARogueGameMode::RunSpawnQuery()
+{
+	if (!CVarDirectorEnabled.GetValueOnGameThread() || ActiveMinions.Num() + QueuedSpawns.Num() >= MaxAliveMinions)
+	{
+		return;
+	}
+
+	float CheapestCost = TNumericLimits<float>::Max();
+	for (const FRogueMinionSpawnInfo& SpawnInfo : MinionTypes)
+	{
+		CheapestCost = FMath::Min(CheapestCost, SpawnInfo.CreditCost);
+	}
+
+	if (Credits < CheapestCost)
+	{
+		return;
+	}
+
+	FEnvQueryRequest QueryRequest(SpawnPointQuery, this);
+	QueryRequest.Execute(EEnvQueryRunMode::AllMatching, FQueryFinishedSignature::CreateUObject(this, &ThisClass::OnSpawnQueryFinished));
+}
+
+void ARogueGameMode::OnSpawnQueryFinished(TSharedPtr<FEnvQueryResult> Result)
+{
+	if (!Result->IsSuccessful())
+	{
+		return;
+	}
+
+	TArray<FVector> Locations;
+	Result->GetAllAsLocations(Locations);
+
+	// Spend the budget as a wave, one minion per location in order of score
+	double QueuedTime = FPlatformTime::Seconds();
+	for (const FVector& Location : Locations)
+	{
+		if (ActiveMinions.Num() + QueuedSpawns.Num() >= MaxAliveMinions)
+		{
+			break;
+		}
+
+		TArray<const FRogueMinionSpawnInfo*, TInlineAllocator<8>> Affordable;
+		for (const FRogueMinionSpawnInfo& SpawnInfo : MinionTypes)
+		{
+			if (SpawnInfo.MinionClass && SpawnInfo.CreditCost <= Credits)
+			{
+				Affordable.Add(&SpawnInfo);
+			}
+		}
+
+		if (Affordable.IsEmpty())
+		{
+			break;
+		}
+
+		const FRogueMinionSpawnInfo* Chosen = Affordable[FMath::RandRange(0, Affordable.Num() - 1)];
+		Credits -= Chosen->CreditCost;
+
+		FRogueQueuedMinionSpawn& QueuedSpawn = QueuedSpawns.AddDefaulted_GetRef();
+		QueuedSpawn.MinionClass = Chosen->MinionClass;
+		QueuedSpawn.Location = Location;
+		QueuedSpawn.CreditCost = Chosen->CreditCost;
+		QueuedSpawn.QueuedTime = QueuedTime;
+	}
+
+	SET_DWORD_STAT(STAT_QueuedMinionSpawns, QueuedSpawns.Num());
+}
+
+void ARogueGameMode::ProcessQueuedSpawns()
+{
+	if (QueuedSpawns.IsEmpty())
+	{
+		return;
+	}
+
+	SCOPE_CYCLE_COUNTER(STAT_DirectorSpawnMinions);
+
+	int32 NumToSpawn = FMath::Min(MaxSpawnsPerFrame, QueuedSpawns.Num());
+	for (int32 i = 0; i < NumToSpawn; i++)
+	{
+		const FRogueQueuedMinionSpawn& QueuedSpawn = QueuedSpawns[i];
+		if (AcquireMinion(QueuedSpawn.MinionClass, QueuedSpawn.Location))
+		{
+			double Latency = FPlatformTime::Seconds() - QueuedSpawn.QueuedTime;
+			TotalSpawnLatency += Latency;
+			PeakSpawnLatency = FMath::Max(PeakSpawnLatency, Latency);
+			NumSpawned++;
+
+			SET_FLOAT_STAT(STAT_MinionSpawnLatency, Latency * 1000.0);
+		}
+		else
+		{
+			Credits = FMath::Min(Credits + QueuedSpawn.CreditCost, MaxCredits);
+		}
+	}
+
+	QueuedSpawns.RemoveAt(0, NumToSpawn, EAllowShrinking::No);
+
+	SET_DWORD_STAT(STAT_QueuedMinionSpawns, QueuedSpawns.Num());
+}
+
+ARogueAICharacter* ARogueGameMode::AcquireMinion(TSubclassOf<ARogueAICharacter> MinionClass, const FVector& Location)
+{
+	FRogueMinionPool& Pool = MinionPools.FindOrAdd(MinionClass);
+
+	// Query locations are on the ground, lift by the capsule to not spawn halfway into the floor
+	float CapsuleHalfHeight = MinionClass->GetDefaultObject<ARogueAICharacter>()->GetCapsuleComponent()->GetScaledCapsuleHalfHeight();
+	FVector SpawnLocation = Location + FVector(0, 0, CapsuleHalfHeight);
+
+	ARogueAICharacter* Minion = nullptr;
+	while (Pool.Inactive.Num() > 0 && Minion == nullptr)
+	{
+		Minion = Pool.Inactive.Pop(EAllowShrinking::No);
+		if (!IsValid(Minion))
+		{
+			Minion = nullptr;
+		}
+	}
+
+	if (Minion == nullptr)
+	{
+		Pool.Misses++;
+		Minion = SpawnMinion(MinionClass, SpawnLocation);
+		if (Minion == nullptr)
+		{
+			return nullptr;
+		}
+
+		// Bound once per minion, it stays bound while pooled and reused
+		Minion->OnEndPlay.AddDynamic(this, &ThisClass::OnMinionEndPlay);
+	}
+	else
+	{
+		Pool.Hits++;
+		DEC_DWORD_STAT(STAT_PooledMinions);
+
+		Minion->TeleportTo(SpawnLocation, Minion->GetActorRotation(), false, true);
+
+		Minion->SetActorHiddenInGame(false);
+		Minion->SetActorEnableCollision(true);
+		Minion->SetActorTickEnabled(true);
+		Minion->GetCharacterMovement()->SetMovementMode(MOVE_Walking);
+
+		URogueActionSystemComponent* ActionComp = Minion->ActionSystemComponent;
+		if (FRogueAttribute* HealthMax = ActionComp->GetAttribute(SharedGameplayTags::Attribute_HealthMax))
+		{
+			ActionComp->ApplyAttributeChange(SharedGameplayTags::Attribute_Health, HealthMax->GetValue(), OverrideBase);
+		}
+
+		if (AAIController* Controller = Cast<AAIController>(Minion->GetController()))
+		{
+			Controller->GetBrainComponent()->RestartLogic();
+		}
+	}
+
+	ActiveMinions.Add(Minion);
+	INC_DWORD_STAT(STAT_AliveMinions);
+
+	return Minion;
+}
+
+ARogueAICharacter* ARogueGameMode::SpawnMinion(TSubclassOf<ARogueAICharacter> MinionClass, const FVector& Location) const
+{
+	FActorSpawnParameters SpawnParams;
+	SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AdjustIfPossibleButAlwaysSpawn;
+
+	ARogueAICharacter* Minion = GetWorld()->SpawnActor<ARogueAICharacter>(MinionClass, Location, FRotator::ZeroRotator,
+	                                                                       SpawnParams);
+	if (Minion && Minion->GetController() == nullptr)
+	{
+		Minion->SpawnDefaultController();
+	}
+
+	return Minion;
+}
+
+void ARogueGameMode::OnMinionKilled(ARogueAICharacter* Minion)
+{
+	if (ActiveMinions.Remove(Minion) > 0)
+	{
+		DEC_DWORD_STAT(STAT_AliveMinions);
+		ReleaseMinion(Minion);
+	}
+}
+
+void ARogueGameMode::OnMinionEndPlay(AActor* InActor, EEndPlayReason::Type EndPlayReason)
+{
+	// Minions can leave play without dying, eg. falling out of the world or the level streaming out
+	ARogueAICharacter* Minion = CastChecked<ARogueAICharacter>(InActor);
+	if (ActiveMinions.Remove(Minion) > 0)
+	{
+		DEC_DWORD_STAT(STAT_AliveMinions);
+	}
+
+	if (FRogueMinionPool* Pool = MinionPools.Find(Minion->GetClass()))
+	{
+		if (Pool->Inactive.Remove(Minion) > 0)
+		{
+			DEC_DWORD_STAT(STAT_PooledMinions);
+		}
+	}
+}
+
+void ARogueGameMode::ReleaseMinion(ARogueAICharacter* Minion)
+{
+	// Controller stays possessed, only the tree is halted until the minion is reused
+	if (AAIController* Controller = Cast<AAIController>(Minion->GetController()))
+	{
+		Controller->GetBrainComponent()->StopLogic(TEXT("Pooled"));
+		Controller->StopMovement();
+	}
+
+	Minion->GetCharacterMovement()->StopMovementImmediately();
+	Minion->GetCharacterMovement()->DisableMovement();
+	Minion->SetActorHiddenInGame(true);
+	Minion->SetActorEnableCollision(false);
+	Minion->SetActorTickEnabled(false);
+
+	MinionPools.FindOrAdd(Minion->GetClass()).Inactive.Add(Minion);
+	INC_DWORD_STAT(STAT_PooledMinions);
+}
+
+void ARogueGameMode::LogDirectorStats() const
+{
+	UE_LOG(LogTemp, Log, TEXT("Director: %d alive, %d queued, %.1f credits, spawn latency avg %.2f ms peak %.2f ms over %d spawns"),
+	       ActiveMinions.Num(),
+	       QueuedSpawns.Num(),
+	       Credits,
+	       NumSpawned > 0 ? TotalSpawnLatency / NumSpawned * 1000.0 : 0.0,
+	       PeakSpawnLatency * 1000.0,
+	       NumSpawned);
+
+	for (const TPair<TSubclassOf<ARogueAICharacter>, FRogueMinionPool>& Pair : MinionPools)
+	{
+		UE_LOG(LogTemp, Log, TEXT("  %s: %d inactive, %d hits, %d misses"),
+		       *GetNameSafe(Pair.Key),
+		       Pair.Value.Inactive.Num(),
+		       Pair.Value.Hits,
+		       Pair.Value.Misses);
+	}
 }
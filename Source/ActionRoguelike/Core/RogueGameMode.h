@@ -6,13 +6,128 @@
 #include "GameFramework/GameModeBase.h"
 #include "RogueGameMode.generated.h"
 
+class ARogueAICharacter;
+class UEnvQuery;
+struct FEnvQueryResult;
+
+USTRUCT()
+struct FRogueMinionSpawnInfo
+{
+	GENERATED_BODY()
+
+	UPROPERTY(EditAnywhere, Category="Director")
+	TSubclassOf<ARogueAICharacter> MinionClass;
+
+	/* Credits the director spends on one of these */
+	UPROPERTY(EditAnywhere, Category="Director", meta=(ClampMin=0.1))
+	float CreditCost = 1.0f;
+
+	/* Spawned into the pool at the start of the match */
+	UPROPERTY(EditAnywhere, Category="Director")
+	int32 PrewarmCount = 4;
+};
+
+/* Spawn decided by the director, waiting for a free slot in the per frame spawn cap */
+struct FRogueQueuedMinionSpawn
+{
+	TSubclassOf<ARogueAICharacter> MinionClass;
+
+	FVector Location = FVector::ZeroVector;
+
+	/* Already taken from Credits when queued, refunded if the minion can't be acquired */
+	float CreditCost = 0.0f;
+
+	double QueuedTime = 0.0;
+};
+
+USTRUCT()
+struct FRogueMinionPool
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	TArray<TObjectPtr<ARogueAICharacter>> Inactive;
+
+	int32 Hits = 0;
+
+	int32 Misses = 0;
+};
+
 /**
- * 
+ * Runs the minion director, credits accumulate over time and are spent on waves spawned at EQS locations
  */
 UCLASS()
 class ACTIONROGUELIKE_API ARogueGameMode : public AGameModeBase
 {
 	GENERATED_BODY()
-	
+
+public:
 	ARogueGameMode();
+
+	/* Killed minions return to the pool together with their controller */
+	void OnMinionKilled(ARogueAICharacter* Minion);
+
+	void LogDirectorStats() const;
+
+	virtual void StartPlay() override;
+
+	virtual void Tick(float DeltaSeconds) override;
+
+protected:
+	UPROPERTY(EditDefaultsOnly, Category="Director")
+	TArray<FRogueMinionSpawnInfo> MinionTypes;
+
+	/* Should return all valid spawn locations, the director picks from the best ones */
+	UPROPERTY(EditDefaultsOnly, Category="Director")
+	TObjectPtr<UEnvQuery> SpawnPointQuery;
+
+	UPROPERTY(EditDefaultsOnly, Category="Director")
+	float SpawnQueryInterval = 2.0f;
+
+	UPROPERTY(EditDefaultsOnly, Category="Director")
+	float CreditsPerSecond = 1.0f;
+
+	UPROPERTY(EditDefaultsOnly, Category="Director")
+	float MaxCredits = 20.0f;
+
+	UPROPERTY(EditDefaultsOnly, Category="Director")
+	int32 MaxAliveMinions = 50;
+
+	/* Spawns beyond this are deferred to the next frames to avoid hitches on large waves */
+	UPROPERTY(EditDefaultsOnly, Category="Director")
+	int32 MaxSpawnsPerFrame = 2;
+
+	void RunSpawnQuery();
+
+	void OnSpawnQueryFinished(TSharedPtr<FEnvQueryResult> Result);
+
+	void ProcessQueuedSpawns();
+
+	ARogueAICharacter* AcquireMinion(TSubclassOf<ARogueAICharacter> MinionClass, const FVector& Location);
+
+	ARogueAICharacter* SpawnMinion(TSubclassOf<ARogueAICharacter> MinionClass, const FVector& Location) const;
+
+	void ReleaseMinion(ARogueAICharacter* Minion);
+
+	UFUNCTION()
+	void OnMinionEndPlay(AActor* InActor, EEndPlayReason::Type EndPlayReason);
+
+	float Credits = 0.0f;
+
+	/* Minions spawned by the director that are currently in play, killed minions not in here were placed in the level */
+	TSet<TObjectKey<ARogueAICharacter>> ActiveMinions;
+
+	FTimerHandle SpawnQueryTimerHandle;
+
+	TArray<FRogueQueuedMinionSpawn> QueuedSpawns;
+
+	UPROPERTY()
+	TMap<TSubclassOf<ARogueAICharacter>, FRogueMinionPool> MinionPools;
+
+	/* Spawn latency telemetry, from the director queuing a spawn until the minion is active */
+	double TotalSpawnLatency = 0.0;
+
+	double PeakSpawnLatency = 0.0;
+
+	int32 NumSpawned = 0;
 };
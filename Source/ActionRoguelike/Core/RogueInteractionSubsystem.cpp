@@ -0,0 +1,239 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "RogueInteractionSubsystem.h"
+
+#include "EngineUtils.h"
+#include "RogueGameTypes.h"
+#include "RogueInteractionInterface.h"
+
+
+void URogueInteractionSubsystem::OnWorldBeginPlay(UWorld& InWorld)
+{
+	Super::OnWorldBeginPlay(InWorld);
+
+	for (TActorIterator<AActor> It(&InWorld); It; ++It)
+	{
+		RegisterInteractable(*It);
+	}
+
+	ActorSpawnedHandle = InWorld.AddOnActorSpawnedHandler(
+		FOnActorSpawned::FDelegate::CreateUObject(this, &ThisClass::OnActorSpawned));
+
+	// Streamed in levels and world partition cells never go through the spawn handler
+	LevelAddedHandle = FWorldDelegates::LevelAddedToWorld.AddUObject(this, &ThisClass::RegisterLevelInteractables);
+}
+
+void URogueInteractionSubsystem::Deinitialize()
+{
+	if (UWorld* World = GetWorld())
+	{
+		World->RemoveOnActorSpawnedHandler(ActorSpawnedHandle);
+	}
+	FWorldDelegates::LevelAddedToWorld.Remove(LevelAddedHandle);
+
+	Super::Deinitialize();
+}
+
+bool URogueInteractionSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void URogueInteractionSubsystem::RegisterLevelInteractables(ULevel* InLevel, UWorld* InWorld)
+{
+	if (InWorld != GetWorld())
+	{
+		return;
+	}
+
+	for (AActor* Actor : InLevel->Actors)
+	{
+		RegisterInteractable(Actor);
+	}
+}
+
+void URogueInteractionSubsystem::OnActorSpawned(AActor* InActor)
+{
+	RegisterInteractable(InActor);
+}
+
+void URogueInteractionSubsystem::RegisterInteractable(AActor* InActor)
+{
+	if (!IsValid(InActor) || !InActor->Implements<URogueInteractionInterface>() || EntryIndexByActor.Contains(InActor))
+	{
+		return;
+	}
+
+	// Match the old overlap query, only Actors that respond to the interaction channel were ever found
+	if (InActor->GetComponentsCollisionResponseToChannel(COLLISION_INTERACTION) == ECR_Ignore)
+	{
+		return;
+	}
+
+	FRogueInteractableEntry NewEntry;
+	NewEntry.Actor = InActor;
+
+	int32 EntryIndex = Entries.Add(NewEntry);
+	EntryIndexByActor.Add(InActor, EntryIndex);
+
+	UpdateEntryBounds(EntryIndex);
+	AddToCells(EntryIndex);
+
+	InActor->OnEndPlay.AddDynamic(this, &ThisClass::OnInteractableEndPlay);
+	if (USceneComponent* RootComp = InActor->GetRootComponent())
+	{
+		Entries[EntryIndex].TransformUpdatedHandle = RootComp->TransformUpdated.AddUObject(
+			this, &ThisClass::OnInteractableMoved);
+	}
+
+	Version++;
+}
+
+void URogueInteractionSubsystem::UnregisterInteractable(AActor* InActor)
+{
+	int32 EntryIndex = INDEX_NONE;
+	if (!EntryIndexByActor.RemoveAndCopyValue(InActor, EntryIndex))
+	{
+		return;
+	}
+
+	RemoveFromCells(EntryIndex);
+
+	InActor->OnEndPlay.RemoveDynamic(this, &ThisClass::OnInteractableEndPlay);
+	if (USceneComponent* RootComp = InActor->GetRootComponent())
+	{
+		RootComp->TransformUpdated.Remove(Entries[EntryIndex].TransformUpdatedHandle);
+	}
+
+	Entries.RemoveAt(EntryIndex);
+
+	Version++;
+}
+
+void URogueInteractionSubsystem::OnInteractableEndPlay(AActor* InActor, EEndPlayReason::Type EndPlayReason)
+{
+	UnregisterInteractable(InActor);
+}
+
+void URogueInteractionSubsystem::OnInteractableMoved(USceneComponent* InRootComponent,
+                                                     EUpdateTransformFlags UpdateTransformFlags, ETeleportType Teleport)
+{
+	const int32* EntryIndex = EntryIndexByActor.Find(InRootComponent->GetOwner());
+	if (EntryIndex == nullptr)
+	{
+		return;
+	}
+
+	RemoveFromCells(*EntryIndex);
+	UpdateEntryBounds(*EntryIndex);
+	AddToCells(*EntryIndex);
+
+	Version++;
+}
+
+void URogueInteractionSubsystem::QueryInteractables(const FVector& Center, float Radius, TArray<AActor*>& OutActors,
+                                                    TArray<FVector>& OutOrigins)
+{
+	CurrentQueryStamp++;
+
+	FIntVector MinCell = ToCell(Center - FVector(Radius));
+	FIntVector MaxCell = ToCell(Center + FVector(Radius));
+	double RadiusSquared = FMath::Square((double)Radius);
+
+	for (int32 X = MinCell.X; X <= MaxCell.X; X++)
+	{
+		for (int32 Y = MinCell.Y; Y <= MaxCell.Y; Y++)
+		{
+			for (int32 Z = MinCell.Z; Z <= MaxCell.Z; Z++)
+			{
+				const TArray<int32>* Cell = Cells.Find(FIntVector(X, Y, Z));
+				if (Cell == nullptr)
+				{
+					continue;
+				}
+
+				for (int32 EntryIndex : *Cell)
+				{
+					FRogueInteractableEntry& Entry = Entries[EntryIndex];
+					if (Entry.QueryStamp == CurrentQueryStamp)
+					{
+						continue;
+					}
+					Entry.QueryStamp = CurrentQueryStamp;
+
+					FBox Bounds(Entry.Origin - Entry.Extent, Entry.Origin + Entry.Extent);
+					if (!FMath::SphereAABBIntersection(Center, RadiusSquared, Bounds))
+					{
+						continue;
+					}
+
+					if (AActor* Actor = Entry.Actor.Get())
+					{
+						OutActors.Add(Actor);
+						OutOrigins.Add(Entry.Origin);
+					}
+				}
+			}
+		}
+	}
+}
+
+void URogueInteractionSubsystem::UpdateEntryBounds(int32 EntryIndex)
+{
+	FRogueInteractableEntry& Entry = Entries[EntryIndex];
+	Entry.Actor->GetActorBounds(true, Entry.Origin, Entry.Extent);
+
+	Entry.MinCell = ToCell(Entry.Origin - Entry.Extent);
+	Entry.MaxCell = ToCell(Entry.Origin + Entry.Extent);
+}
+
+void URogueInteractionSubsystem::AddToCells(int32 EntryIndex)
+{
+	const FRogueInteractableEntry& Entry = Entries[EntryIndex];
+
+	for (int32 X = Entry.MinCell.X; X <= Entry.MaxCell.X; X++)
+	{
+		for (int32 Y = Entry.MinCell.Y; Y <= Entry.MaxCell.Y; Y++)
+		{
+			for (int32 Z = Entry.MinCell.Z; Z <= Entry.MaxCell.Z; Z++)
+			{
+				Cells.FindOrAdd(FIntVector(X, Y, Z)).Add(EntryIndex);
+			}
+		}
+	}
+}
+
+void URogueInteractionSubsystem::RemoveFromCells(int32 EntryIndex)
+{
+	const FRogueInteractableEntry& Entry = Entries[EntryIndex];
+
+	for (int32 X = Entry.MinCell.X; X <= Entry.MaxCell.X; X++)
+	{
+		for (int32 Y = Entry.MinCell.Y; Y <= Entry.MaxCell.Y; Y++)
+		{
+			for (int32 Z = Entry.MinCell.Z; Z <= Entry.MaxCell.Z; Z++)
+			{
+				FIntVector CellCoord(X, Y, Z);
+				TArray<int32>* Cell = Cells.Find(CellCoord);
+				if (Cell == nullptr)
+				{
+					continue;
+				}
+
+				Cell->RemoveSingleSwap(EntryIndex);
+				if (Cell->IsEmpty())
+				{
+					Cells.Remove(CellCoord);
+				}
+			}
+		}
+	}
+}
+
+FIntVector URogueInteractionSubsystem::ToCell(const FVector& Location) const
+{
+	return FIntVector(FMath::FloorToInt32(Location.X / CellSize),
+	                  FMath::FloorToInt32(Location.Y / CellSize),
+	                  FMath::FloorToInt32(Location.Z / CellSize));
+}
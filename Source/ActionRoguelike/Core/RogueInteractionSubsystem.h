@@ -0,0 +1,90 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "RogueInteractionSubsystem.generated.h"
+
+struct FRogueInteractableEntry
+{
+	TWeakObjectPtr<AActor> Actor;
+
+	/* Colliding bounds, same as GetActorBounds(true) */
+	FVector Origin = FVector::ZeroVector;
+
+	FVector Extent = FVector::ZeroVector;
+
+	/* Range of grid cells the bounds are inserted into */
+	FIntVector MinCell = FIntVector::ZeroValue;
+
+	FIntVector MaxCell = FIntVector::ZeroValue;
+
+	/* Avoids returning an entry twice when it spans multiple cells */
+	uint32 QueryStamp = 0;
+
+	FDelegateHandle TransformUpdatedHandle;
+};
+
+/* Uniform grid of every Actor implementing IRogueInteractionInterface, replaces per frame overlap queries for interaction */
+UCLASS()
+class ACTIONROGUELIKE_API URogueInteractionSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	void RegisterInteractable(AActor* InActor);
+
+	void UnregisterInteractable(AActor* InActor);
+
+	/* Interactables whose bounds touch the sphere, returned as parallel arrays of Actor and bounds origin */
+	void QueryInteractables(const FVector& Center, float Radius, TArray<AActor*>& OutActors, TArray<FVector>& OutOrigins);
+
+	/* Bumped whenever an interactable is added, removed or moved, callers can skip re-scoring while it is unchanged */
+	uint32 GetVersion() const
+	{
+		return Version;
+	}
+
+	virtual void OnWorldBeginPlay(UWorld& InWorld) override;
+
+	virtual void Deinitialize() override;
+
+protected:
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+	void RegisterLevelInteractables(ULevel* InLevel, UWorld* InWorld);
+
+	void OnActorSpawned(AActor* InActor);
+
+	UFUNCTION()
+	void OnInteractableEndPlay(AActor* InActor, EEndPlayReason::Type EndPlayReason);
+
+	void OnInteractableMoved(USceneComponent* InRootComponent, EUpdateTransformFlags UpdateTransformFlags,
+	                         ETeleportType Teleport);
+
+	void UpdateEntryBounds(int32 EntryIndex);
+
+	void AddToCells(int32 EntryIndex);
+
+	void RemoveFromCells(int32 EntryIndex);
+
+	FIntVector ToCell(const FVector& Location) const;
+
+	/* Should be in the range of the interaction radius, smaller cells waste time on duplicate entries of large Actors */
+	float CellSize = 1000.0f;
+
+	TSparseArray<FRogueInteractableEntry> Entries;
+
+	TMap<TObjectKey<AActor>, int32> EntryIndexByActor;
+
+	TMap<FIntVector, TArray<int32>> Cells;
+
+	uint32 Version = 0;
+
+	uint32 CurrentQueryStamp = 0;
+
+	FDelegateHandle ActorSpawnedHandle;
+
+	FDelegateHandle LevelAddedHandle;
+};
@@ -3,20 +3,175 @@
 
 #include "RogueInteractionComponent.h"
 
-#include "RogueGameTypes.h"
+#include "ActionRoguelike.h"
 #include "Core/RogueInteractionInterface.h"
-#include "Engine/OverlapResult.h"
+#include "Core/RogueInteractionSubsystem.h"
+
+DECLARE_CYCLE_STAT(TEXT("UpdateInteractionSelection"), STAT_UpdateInteractionSelection, STATGROUP_ActionRoguelike);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Interaction Candidates Scored"), STAT_InteractionCandidatesScored, STATGROUP_ActionRoguelike);
 
 TAutoConsoleVariable<bool> CVarInteractionDebugDrawing(TEXT("game.interaction.DebugDraw"), false,
                                                        TEXT(
 	                                                       "Enable interaction component debug rendering. (0 = Off, 1 = enabled)"),
                                                        ECVF_Cheat);
 
+namespace RogueInteraction
+{
+	/* Reference implementation, matches the per candidate math of the debug path */
+	static void ScoreCandidatesScalar(const float* OffsetsX, const float* OffsetsY, const float* OffsetsZ, int32 Num,
+	                                  const FVector3f& CameraOffset, const FVector3f& Forward, float RadiusSquared,
+	                                  float DistWeightScale, float DirectionWeightScale, float* OutWeights)
+	{
+		for (int32 Index = 0; Index < Num; Index++)
+		{
+			FVector3f Delta(OffsetsX[Index] - CameraOffset.X, OffsetsY[Index] - CameraOffset.Y,
+			                OffsetsZ[Index] - CameraOffset.Z);
+
+			float NormalizedDistance = 1.f - (Delta.SizeSquared() / RadiusSquared);
+			float NormalizedDot = FVector3f::DotProduct(Delta.GetSafeNormal(), Forward) * 0.5f + 0.5f;
+			OutWeights[Index] = (NormalizedDot * DirectionWeightScale) + (NormalizedDistance * DistWeightScale);
+		}
+	}
+
+	/* Scores four candidates per iteration, all arrays must be padded to a multiple of four */
+	static void ScoreCandidatesVectorized(const float* OffsetsX, const float* OffsetsY, const float* OffsetsZ,
+	                                      int32 NumPadded, const FVector3f& CameraOffset, const FVector3f& Forward,
+	                                      float RadiusSquared, float DistWeightScale, float DirectionWeightScale,
+	                                      float* OutWeights)
+	{
+		check(NumPadded % 4 == 0);
+
+		const VectorRegister4Float CameraX = VectorSetFloat1(CameraOffset.X);
+		const VectorRegister4Float CameraY = VectorSetFloat1(CameraOffset.Y);
+		const VectorRegister4Float CameraZ = VectorSetFloat1(CameraOffset.Z);
+		const VectorRegister4Float ForwardX = VectorSetFloat1(Forward.X);
+		const VectorRegister4Float ForwardY = VectorSetFloat1(Forward.Y);
+		const VectorRegister4Float ForwardZ = VectorSetFloat1(Forward.Z);
+		const VectorRegister4Float InvRadiusSquared = VectorSetFloat1(1.f / RadiusSquared);
+		const VectorRegister4Float DistScale = VectorSetFloat1(DistWeightScale);
+		const VectorRegister4Float DirectionScale = VectorSetFloat1(DirectionWeightScale * 0.5f);
+		// Constant part of both terms, DirectionWeightScale * 0.5 from the dot remap plus DistWeightScale * 1
+		const VectorRegister4Float ConstantWeight = VectorSetFloat1(DirectionWeightScale * 0.5f + DistWeightScale);
+		// Same threshold as GetSafeNormal, candidates on top of the camera get a zero direction
+		const VectorRegister4Float SafeNormalThreshold = VectorSetFloat1(SMALL_NUMBER);
+
+		for (int32 Index = 0; Index < NumPadded; Index += 4)
+		{
+			VectorRegister4Float DeltaX = VectorSubtract(VectorLoad(OffsetsX + Index), CameraX);
+			VectorRegister4Float DeltaY = VectorSubtract(VectorLoad(OffsetsY + Index), CameraY);
+			VectorRegister4Float DeltaZ = VectorSubtract(VectorLoad(OffsetsZ + Index), CameraZ);
+
+			VectorRegister4Float DistSquared = VectorMultiply(DeltaX, DeltaX);
+			DistSquared = VectorMultiplyAdd(DeltaY, DeltaY, DistSquared);
+			DistSquared = VectorMultiplyAdd(DeltaZ, DeltaZ, DistSquared);
+
+			VectorRegister4Float Dot = VectorMultiply(DeltaX, ForwardX);
+			Dot = VectorMultiplyAdd(DeltaY, ForwardY, Dot);
+			Dot = VectorMultiplyAdd(DeltaZ, ForwardZ, Dot);
+			Dot = VectorDivide(Dot, VectorSqrt(DistSquared));
+			Dot = VectorSelect(VectorCompareLT(DistSquared, SafeNormalThreshold), VectorZeroFloat(), Dot);
+
+			// ConstantWeight + Dot * DirectionScale - DistSquared / RadiusSquared * DistScale
+			VectorRegister4Float Weight = VectorMultiplyAdd(Dot, DirectionScale, ConstantWeight);
+			Weight = VectorSubtract(Weight, VectorMultiply(VectorMultiply(DistSquared, InvRadiusSquared), DistScale));
+
+			VectorStore(Weight, OutWeights + Index);
+		}
+	}
+
+	/* Index of the highest weight above zero, first one wins on ties same as the scalar loop */
+	static int32 FindBestCandidate(const float* Weights, int32 Num)
+	{
+		int32 BestIndex = INDEX_NONE;
+		float HighestWeight = 0.0f;
+		for (int32 Index = 0; Index < Num; Index++)
+		{
+			if (Weights[Index] > HighestWeight)
+			{
+				BestIndex = Index;
+				HighestWeight = Weights[Index];
+			}
+		}
+		return BestIndex;
+	}
+}
+
+#if !UE_BUILD_SHIPPING
+static void BenchmarkInteractionScoring()
+{
+	constexpr float Radius = 800.f;
+	constexpr int32 Iterations = 10000;
+
+	FRandomStream RandomStream(1337);
+
+	for (int32 NumCandidates : {10, 100, 1000})
+	{
+		int32 NumPadded = Align(NumCandidates, 4);
+
+		TArray<float> OffsetsX, OffsetsY, OffsetsZ, Weights;
+		OffsetsX.SetNumZeroed(NumPadded);
+		OffsetsY.SetNumZeroed(NumPadded);
+		OffsetsZ.SetNumZeroed(NumPadded);
+		Weights.SetNumZeroed(NumPadded);
+
+		for (int32 Index = 0; Index < NumCandidates; Index++)
+		{
+			FVector3f Offset = FVector3f(RandomStream.GetUnitVector()) * RandomStream.FRandRange(0.f, Radius);
+			OffsetsX[Index] = Offset.X;
+			OffsetsY[Index] = Offset.Y;
+			OffsetsZ[Index] = Offset.Z;
+		}
+
+		FVector3f CameraOffset(-300.f, 0.f, 150.f);
+		FVector3f Forward = FVector3f(RandomStream.GetUnitVector());
+
+		int32 ScalarBest = INDEX_NONE;
+		double StartTime = FPlatformTime::Seconds();
+		for (int32 It = 0; It < Iterations; It++)
+		{
+			RogueInteraction::ScoreCandidatesScalar(OffsetsX.GetData(), OffsetsY.GetData(), OffsetsZ.GetData(),
+			                                        NumCandidates, CameraOffset, Forward, Radius * Radius, 1.f, 2.f,
+			                                        Weights.GetData());
+			ScalarBest = RogueInteraction::FindBestCandidate(Weights.GetData(), NumCandidates);
+		}
+		double ScalarTime = FPlatformTime::Seconds() - StartTime;
+
+		int32 VectorBest = INDEX_NONE;
+		StartTime = FPlatformTime::Seconds();
+		for (int32 It = 0; It < Iterations; It++)
+		{
+			RogueInteraction::ScoreCandidatesVectorized(OffsetsX.GetData(), OffsetsY.GetData(), OffsetsZ.GetData(),
+			                                            NumPadded, CameraOffset, Forward, Radius * Radius, 1.f, 2.f,
+			                                            Weights.GetData());
+			VectorBest = RogueInteraction::FindBestCandidate(Weights.GetData(), NumCandidates);
+		}
+		double VectorTime = FPlatformTime::Seconds() - StartTime;
+
+		UE_LOG(LogTemp, Log, TEXT("Interaction scoring, %d candidates: scalar %.3f us, vectorized %.3f us (best %d / %d)"),
+		       NumCandidates,
+		       ScalarTime / Iterations * 1000000.0,
+		       VectorTime / Iterations * 1000000.0,
+		       ScalarBest, VectorBest);
+	}
+}
+
+FAutoConsoleCommand BenchmarkInteractionScoringCommand(TEXT("game.interaction.BenchmarkScoring"),
+                                                       TEXT("Compare scalar and vectorized interaction scoring at 10, 100 and 1000 candidates."),
+                                                       FConsoleCommandDelegate::CreateStatic(&BenchmarkInteractionScoring));
+#endif
+
 URogueInteractionComponent::URogueInteractionComponent()
 {
 	PrimaryComponentTick.bCanEverTick = true;
 }
 
+void URogueInteractionComponent::BeginPlay()
+{
+	Super::BeginPlay();
+
+	SetComponentTickInterval(SelectionUpdateInterval);
+}
+
 void URogueInteractionComponent::Interact()
 {
 	if (SelectedActor && SelectedActor->Implements<URogueInteractionInterface>())
@@ -30,41 +185,89 @@ void URogueInteractionComponent::TickComponent(float DeltaTime, ELevelTick TickT
 {
 	Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
 
+	SCOPE_CYCLE_COUNTER(STAT_UpdateInteractionSelection);
+
 	APlayerController* PC = CastChecked<APlayerController>(GetOwner());
 
 	FVector Center = PC->GetPawn()->GetActorLocation();
 	FVector CameraLocation = PC->PlayerCameraManager->GetCameraLocation();
-	ECollisionChannel CollisionChannel = COLLISION_INTERACTION;
+	FRotator ControlRotation = PC->GetControlRotation();
+
+	URogueInteractionSubsystem* InteractionSubsystem = GetWorld()->GetSubsystem<URogueInteractionSubsystem>();
+	uint32 InteractablesVersion = InteractionSubsystem->GetVersion();
+
+	bool bEnabledDebugDraw = CVarInteractionDebugDrawing.GetValueOnGameThread();
+
+	// Nothing moved since the last pass, the same actor would be selected again
+	if (!bEnabledDebugDraw && InteractablesVersion == LastInteractablesVersion && Center == LastCenter
+		&& CameraLocation == LastCameraLocation && ControlRotation == LastControlRotation)
+	{
+		return;
+	}
+
+	if (InteractablesVersion != LastInteractablesVersion || Center != LastCenter)
+	{
+		CandidateActors.Reset();
+		CandidateOrigins.Reset();
+		InteractionSubsystem->QueryInteractables(Center, InteractionRadius, CandidateActors, CandidateOrigins);
+
+		// Pack relative to the pawn so the offsets stay small enough for float precision
+		int32 NumPadded = Align(CandidateActors.Num(), 4);
+		CandidateOffsetsX.SetNumZeroed(NumPadded);
+		CandidateOffsetsY.SetNumZeroed(NumPadded);
+		CandidateOffsetsZ.SetNumZeroed(NumPadded);
+		CandidateWeights.SetNumZeroed(NumPadded);
+
+		for (int32 Index = 0; Index < CandidateActors.Num(); Index++)
+		{
+			FVector3f Offset = FVector3f(CandidateOrigins[Index] - Center);
+			CandidateOffsetsX[Index] = Offset.X;
+			CandidateOffsetsY[Index] = Offset.Y;
+			CandidateOffsetsZ[Index] = Offset.Z;
+		}
+	}
+
+	LastInteractablesVersion = InteractablesVersion;
+	LastCenter = Center;
+	LastCameraLocation = CameraLocation;
+	LastControlRotation = ControlRotation;
 
-	FCollisionShape Shape;
-	Shape.SetSphere(InteractionRadius);
 	float InteractionRadiusSquared = InteractionRadius * InteractionRadius;
 
-	TArray<FOverlapResult> Overlaps;
-	GetWorld()->OverlapMultiByChannel(Overlaps, Center, FQuat::Identity, CollisionChannel, Shape);
+	INC_DWORD_STAT_BY(STAT_InteractionCandidatesScored, CandidateActors.Num());
+
+	if (!bEnabledDebugDraw)
+	{
+		RogueInteraction::ScoreCandidatesVectorized(CandidateOffsetsX.GetData(), CandidateOffsetsY.GetData(),
+		                                            CandidateOffsetsZ.GetData(), CandidateWeights.Num(),
+		                                            FVector3f(CameraLocation - Center),
+		                                            FVector3f(ControlRotation.Vector()), InteractionRadiusSquared,
+		                                            DistWeightScale, DirectionWeightScale,
+		                                            CandidateWeights.GetData());
+
+		int32 BestIndex = RogueInteraction::FindBestCandidate(CandidateWeights.GetData(), CandidateActors.Num());
+		SelectedActor = BestIndex != INDEX_NONE ? CandidateActors[BestIndex] : nullptr;
+		return;
+	}
 
+	// Debug drawing keeps the scalar loop to print the individual terms per candidate
 	AActor* BestActor = nullptr;
 	float HighestWeight = 0.0;
 
-	bool bEnabledDebugDraw = CVarInteractionDebugDrawing.GetValueOnGameThread();
-
-	for (FOverlapResult& Overlap : Overlaps)
+	for (int32 Index = 0; Index < CandidateActors.Num(); Index++)
 	{
-		FVector Origin;
-		FVector BoxExtends;
-		Overlap.GetActor()->GetActorBounds(true,Origin,BoxExtends);
-		
-		FVector OverlapLocation = Overlap.GetActor()->GetActorLocation();
+		FVector Origin = CandidateOrigins[Index];
+
 		FVector OverlapDirection = (Origin - CameraLocation).GetSafeNormal();
 		float DistanceToSquared = (Origin - CameraLocation).SizeSquared();
 		float NormalizedDistance = 1.f - (DistanceToSquared / InteractionRadiusSquared);
 
-		float DotResult = FVector::DotProduct(OverlapDirection, PC->GetControlRotation().Vector());
+		float DotResult = FVector::DotProduct(OverlapDirection, ControlRotation.Vector());
 		float NormalizedDotResult = DotResult * 0.5f + 0.5f;
 		float Wieght = (NormalizedDotResult * DirectionWeightScale) + (NormalizedDistance * DistWeightScale);
 		if (Wieght > HighestWeight)
 		{
-			BestActor = Overlap.GetActor();
+			BestActor = CandidateActors[Index];
 			HighestWeight = Wieght;
 		}
 
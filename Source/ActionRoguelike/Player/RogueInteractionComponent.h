@@ -22,13 +22,42 @@ protected:
 	UPROPERTY(EditDefaultsOnly, Category="Interaction")
 	float DirectionWeightScale = 2.f;
 
+	/* Seconds between selection updates, 0 updates every frame */
+	UPROPERTY(EditDefaultsOnly, Category="Interaction")
+	float SelectionUpdateInterval = 0.0f;
+
 	UPROPERTY()
 	TObjectPtr<AActor> SelectedActor;
 
+	/* Inputs of the last scoring pass, the selection only needs refreshing once any of these change */
+	FVector LastCenter = FVector::ZeroVector;
+
+	FVector LastCameraLocation = FVector::ZeroVector;
+
+	FRotator LastControlRotation = FRotator::ZeroRotator;
+
+	uint32 LastInteractablesVersion = MAX_uint32;
+
+	TArray<AActor*> CandidateActors;
+
+	TArray<FVector> CandidateOrigins;
+
+	/* Candidate origins relative to LastCenter as separate components, padded to a multiple of four for the scoring kernel */
+	TArray<float> CandidateOffsetsX;
+
+	TArray<float> CandidateOffsetsY;
+
+	TArray<float> CandidateOffsetsZ;
+
+	TArray<float> CandidateWeights;
+
 public:
 	URogueInteractionComponent();
 
 	void Interact();
+
+	virtual void BeginPlay() override;
+
 	virtual void TickComponent(float DeltaTime, ELevelTick TickType,
 	                           FActorComponentTickFunction* ThisTickFunction) override;
 };
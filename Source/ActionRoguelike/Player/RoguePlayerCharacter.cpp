@@ -4,6 +4,7 @@
 #include "GameplayTagContainer.h"
 #include "SharedGameplayTags.h"
 #include "ActionSystem/RogueActionSystemComponent.h"
+#include "AI/RogueEQSCacheSubsystem.h"
 #include "Camera/CameraComponent.h"
 #include "GameFramework/PawnMovementComponent.h"
 #include "GameFramework/SpringArmComponent.h"
@@ -98,6 +99,21 @@ void ARoguePlayerCharacter::OnHealthChanged(float NewHealth, float OldHealth)
 	}
 }
 
+bool ARoguePlayerCharacter::TeleportTo(const FVector& DestLocation, const FRotator& DestRotation, bool bIsATest,
+                                       bool bNoCheck)
+{
+	bool bTeleported = Super::TeleportTo(DestLocation, DestRotation, bIsATest, bNoCheck);
+	if (bTeleported && !bIsATest)
+	{
+		if (URogueEQSCacheSubsystem* EQSCache = GetWorld()->GetSubsystem<URogueEQSCacheSubsystem>())
+		{
+			EQSCache->InvalidateTarget(this);
+		}
+	}
+
+	return bTeleported;
+}
+
 void ARoguePlayerCharacter::StartAction(FGameplayTag InActionName)
 {
 	ActionSystemComponent->StartAction(InActionName);
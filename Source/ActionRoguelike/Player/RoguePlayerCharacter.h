@@ -71,4 +71,8 @@ protected:
 public:
 	virtual void PostInitializeComponents() override;
 	virtual void SetupPlayerInputComponent(class UInputComponent* PlayerInputComponent) override;
+
+	/* Also drops cached AI queries against the player, the jump may be far larger than their move threshold */
+	virtual bool TeleportTo(const FVector& DestLocation, const FRotator& DestRotation, bool bIsATest = false,
+	                        bool bNoCheck = false) override;
 };
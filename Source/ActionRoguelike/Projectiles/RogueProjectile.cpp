@@ -5,9 +5,10 @@
 #include "Components/SphereComponent.h"
 #include "GameFramework/ProjectileMovementComponent.h"
 #include "NiagaraComponent.h"
-#include "NiagaraFunctionLibrary.h"
+#include "RogueProjectileSubsystem.h"
 #include "Components/AudioComponent.h"
-#include "Kismet/GameplayStatics.h"
+#include "Core/RogueAssetPreloadSubsystem.h"
+#include "Core/RogueEffectSubsystem.h"
 
 
 ARogueProjectile::ARogueProjectile()
@@ -33,13 +34,20 @@ void ARogueProjectile::OnActorHit(UPrimitiveComponent* HitComponent, AActor* Oth
 {
 	PlayExplodeEffects();
 	
-	Destroy();
+	FinishProjectile();
 }
 
 void ARogueProjectile::PlayExplodeEffects()
 {
-	UNiagaraFunctionLibrary::SpawnSystemAtLocation(this, ExplosionEffect, GetActorLocation());
-	UGameplayStatics::PlaySoundAtLocation(this, ExplosionSound, GetActorLocation(), FRotator::ZeroRotator);
+	URogueEffectSubsystem* EffectSubsystem = GetWorld()->GetSubsystem<URogueEffectSubsystem>();
+	EffectSubsystem->PlayEffectAtLocation(RogueAssets::GetLoaded(ExplosionEffect), GetActorLocation());
+	EffectSubsystem->PlaySoundAtLocation(RogueAssets::GetLoaded(ExplosionSound), GetActorLocation());
+}
+
+void ARogueProjectile::GetAssetsToPreload(TArray<FSoftObjectPath>& OutAssetPaths) const
+{
+	OutAssetPaths.Add(ExplosionEffect.ToSoftObjectPath());
+	OutAssetPaths.Add(ExplosionSound.ToSoftObjectPath());
 }
 
 void ARogueProjectile::PostInitializeComponents()
@@ -47,5 +55,98 @@ void ARogueProjectile::PostInitializeComponents()
 	Super::PostInitializeComponents();
 	
 	SphereComponent->OnComponentHit.AddDynamic(this, &ARogueProjectile::OnActorHit);
+}
+
+void ARogueProjectile::BeginPlay()
+{
+	Super::BeginPlay();
+
+	// Pooled projectiles are launched by the subsystem once they are acquired
+	if (!bIsPooled)
+	{
+		OnLaunched();
+	}
+}
+
+void ARogueProjectile::OnLaunched()
+{
 	SphereComponent->IgnoreActorWhenMoving(GetInstigator(), true);
+
+	if (bUseBatchedMovement)
+	{
+		// The component only provides the launch velocity, the subsystem takes over from here
+		ProjectileMovementComponent->Deactivate();
+		GetWorld()->GetSubsystem<URogueProjectileSubsystem>()->RegisterBatchedProjectile(
+			this, ProjectileMovementComponent->Velocity, ProjectileMovementComponent->GetGravityZ());
+	}
+}
+
+void ARogueProjectile::StopProjectileMovement()
+{
+	ProjectileMovementComponent->StopMovementImmediately();
+
+	if (BatchedIndex != INDEX_NONE)
+	{
+		GetWorld()->GetSubsystem<URogueProjectileSubsystem>()->UnregisterBatchedProjectile(this);
+	}
+}
+
+void ARogueProjectile::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	if (BatchedIndex != INDEX_NONE)
+	{
+		GetWorld()->GetSubsystem<URogueProjectileSubsystem>()->UnregisterBatchedProjectile(this);
+	}
+
+	Super::EndPlay(EndPlayReason);
+}
+
+void ARogueProjectile::FinishProjectile()
+{
+	if (bIsPooled)
+	{
+		GetWorld()->GetSubsystem<URogueProjectileSubsystem>()->ReleaseProjectile(this);
+		return;
+	}
+
+	Destroy();
+}
+
+void ARogueProjectile::LifeSpanExpired()
+{
+	FinishProjectile();
+}
+
+void ARogueProjectile::OnAcquiredFromPool()
+{
+	SetActorHiddenInGame(false);
+	SetActorEnableCollision(true);
+
+	// A blocking hit detaches the movement component from its root and zeroes the velocity
+	ProjectileMovementComponent->SetUpdatedComponent(SphereComponent);
+	ProjectileMovementComponent->Velocity = GetActorForwardVector() * ProjectileMovementComponent->InitialSpeed;
+	ProjectileMovementComponent->Activate(true);
+
+	LoopedNiagaraComponent->Activate(true);
+	LoopedAudioComponent->Play();
+
+	SetLifeSpan(InitialLifeSpan);
+
+	OnLaunched();
+}
+
+void ARogueProjectile::OnReleasedToPool()
+{
+	GetWorldTimerManager().ClearAllTimersForObject(this);
+	SetLifeSpan(0.0f);
+
+	StopProjectileMovement();
+	ProjectileMovementComponent->Deactivate();
+
+	LoopedNiagaraComponent->DeactivateImmediate();
+	LoopedAudioComponent->Stop();
+
+	SphereComponent->ClearMoveIgnoreActors();
+	SetActorEnableCollision(false);
+	SetActorHiddenInGame(true);
 }
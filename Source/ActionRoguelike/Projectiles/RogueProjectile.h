@@ -32,19 +32,57 @@ protected:
 	UPROPERTY(EditDefaultsOnly, Category="Components")
 	TObjectPtr<UAudioComponent> LoopedAudioComponent;
 
+	/* Soft referenced, streamed in along with the action firing this projectile */
 	UPROPERTY(EditDefaultsOnly, Category="Effects")
-	TObjectPtr<UNiagaraSystem> ExplosionEffect;
+	TSoftObjectPtr<UNiagaraSystem> ExplosionEffect;
 
 	UPROPERTY(EditDefaultsOnly, Category="Sound")
-	TObjectPtr<USoundBase> ExplosionSound;
+	TSoftObjectPtr<USoundBase> ExplosionSound;
+
+	/* Lightweight mode, URogueProjectileSubsystem moves this projectile in a batch with all others instead of the ProjectileMovementComponent ticking on its own */
+	UPROPERTY(EditDefaultsOnly, Category="Projectile")
+	bool bUseBatchedMovement = false;
+
+	/* Slot in the subsystem's batched movement arrays while moved in a batch */
+	int32 BatchedIndex = INDEX_NONE;
 
 	UFUNCTION()
 	virtual void OnActorHit(UPrimitiveComponent* HitComponent, AActor* OtherActor, UPrimitiveComponent* OtherComp, FVector NormalImpulse, const FHitResult& Hit);
 
 	void PlayExplodeEffects();
-	
+
+	/* Instigator dependent setup, runs from BeginPlay or OnAcquiredFromPool so every shot gets it */
+	virtual void OnLaunched();
+
+	/* Return to the pool or Destroy when this projectile was spawned outside of URogueProjectileSubsystem */
+	void FinishProjectile();
+
+	/* Halts movement in either mode, use instead of calling StopMovementImmediately directly */
+	void StopProjectileMovement();
+
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+	virtual void LifeSpanExpired() override;
+
+	virtual void BeginPlay() override;
+
+	friend class URogueProjectileSubsystem;
+
+	/* Owned by URogueProjectileSubsystem, recycled instead of destroyed */
+	bool bIsPooled = false;
+
+	/* Pooled and currently hidden, waiting to be acquired again */
+	bool bIsInPool = false;
+
+	/* Pooled projectiles are hidden and inert between OnReleasedToPool and the next OnAcquiredFromPool */
+	virtual void OnAcquiredFromPool();
+	virtual void OnReleasedToPool();
+
 public:
 
+	/* Soft referenced effects, gathered by whatever fires this projectile to stream them in ahead of time */
+	virtual void GetAssetsToPreload(TArray<FSoftObjectPath>& OutAssetPaths) const;
+
 	virtual void PostInitializeComponents() override;
 
 	ARogueProjectile();
@@ -31,9 +31,30 @@ void ARogueProjectileBlackhole::PostInitializeComponents()
 
 	// Note: Make sure GenerateOverlapEvents is enabled on the cubes in the world
 	SphereComponent->OnComponentBeginOverlap.AddDynamic(this, &ARogueProjectileBlackhole::OnSphereOverlappedActor);
+}
+
+void ARogueProjectileBlackhole::OnLaunched()
+{
+	Super::OnLaunched();
+
 	GetInstigator()->MoveIgnoreActorAdd(this);
 }
 
+void ARogueProjectileBlackhole::OnAcquiredFromPool()
+{
+	RadialForceComponent->Activate(true);
+
+	Super::OnAcquiredFromPool();
+}
+
+void ARogueProjectileBlackhole::OnReleasedToPool()
+{
+	Super::OnReleasedToPool();
+
+	// Keeps pulling on everything around it while waiting in the pool otherwise
+	RadialForceComponent->Deactivate();
+}
+
 void ARogueProjectileBlackhole::OnSphereOverlappedActor(UPrimitiveComponent* OverlappedComponent, AActor* OtherActor,
 	UPrimitiveComponent* OtherComp, int32 OtherBodyIndex, bool bFromSweep, const FHitResult& SweepResult)
 {
@@ -22,6 +22,12 @@ protected:
 	void OnSphereOverlappedActor(UPrimitiveComponent* OverlappedComponent, AActor* OtherActor, UPrimitiveComponent* OtherComp,
 		int32 OtherBodyIndex, bool bFromSweep, const FHitResult & SweepResult);
 
+	virtual void OnLaunched() override;
+
+	virtual void OnAcquiredFromPool() override;
+
+	virtual void OnReleasedToPool() override;
+
 public:
 	
 	virtual void PostInitializeComponents() override;
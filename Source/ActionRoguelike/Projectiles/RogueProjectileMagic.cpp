@@ -14,12 +14,12 @@ ARogueProjectileMagic::ARogueProjectileMagic()
 void ARogueProjectileMagic::OnActorHit(UPrimitiveComponent* HitComponent, AActor* OtherActor,
 	UPrimitiveComponent* OtherComp, FVector NormalImpulse, const FHitResult& Hit)
 {
-	// Keep the base implementation
-	Super::OnActorHit(HitComponent, OtherActor, OtherComp, NormalImpulse, Hit);
-
 	FVector HitFromDirection = GetActorRotation().Vector();
 	
 	UGameplayStatics::ApplyPointDamage(OtherActor, 10.f, HitFromDirection, Hit,  GetInstigatorController(),
 		this, DmgTypeClass);
+
+	// Keep the base implementation, last as it may hand this projectile back to the pool
+	Super::OnActorHit(HitComponent, OtherActor, OtherComp, NormalImpulse, Hit);
 }
 
@@ -0,0 +1,423 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "RogueProjectileSubsystem.h"
+
+#include "ActionRoguelike.h"
+#include "RogueProjectile.h"
+#include "ActionSystem/RogueActionSystemComponent.h"
+#include "Components/SphereComponent.h"
+#include "GameFramework/Character.h"
+
+TAutoConsoleVariable<bool> CVarProjectilePooling(TEXT("game.projectile.Pooling"), true,
+                                                 TEXT("Recycle projectile Actors instead of spawning new ones. (0 = Off, 1 = enabled)"),
+                                                 ECVF_Cheat);
+
+static FAutoConsoleCommandWithWorld LogProjectilePoolsCommand(TEXT("game.projectile.LogPools"),
+                                                              TEXT("Log hit/miss/peak counters of all projectile pools."),
+                                                              FConsoleCommandWithWorldDelegate::CreateLambda([](UWorld* World)
+                                                              {
+	                                                              if (URogueProjectileSubsystem* Subsystem = World->GetSubsystem<URogueProjectileSubsystem>())
+	                                                              {
+		                                                              Subsystem->LogPoolStats();
+	                                                              }
+                                                              }));
+
+TAutoConsoleVariable<bool> CVarProjectileAsyncBatchedSweeps(TEXT("game.projectile.AsyncBatchedSweeps"), false,
+                                                              TEXT("Sweep batched projectiles with async traces, results are applied one frame later. (0 = Off, 1 = enabled)"),
+                                                              ECVF_Cheat);
+
+DECLARE_CYCLE_STAT(TEXT("Fire Volleys"), STAT_FireVolleys, STATGROUP_ActionRoguelike);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Volley Shots"), STAT_VolleyShots, STATGROUP_ActionRoguelike);
+DECLARE_CYCLE_STAT(TEXT("Batched Projectile Movement"), STAT_BatchedProjectileMovement, STATGROUP_ActionRoguelike);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Batched Projectiles"), STAT_BatchedProjectiles, STATGROUP_ActionRoguelike);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Active Pooled Projectiles"), STAT_ActivePooledProjectiles, STATGROUP_ActionRoguelike);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Projectile Pool Misses"), STAT_ProjectilePoolMisses, STATGROUP_ActionRoguelike);
+
+
+ARogueProjectile* URogueProjectileSubsystem::SpawnProjectile(TSubclassOf<ARogueProjectile> ProjectileClass,
+                                                            const FTransform& SpawnTransform, APawn* InInstigator)
+{
+	// Eg. an unset or not yet loaded soft class on the attacking action
+	if (!ensure(ProjectileClass))
+	{
+		return nullptr;
+	}
+
+	if (!CVarProjectilePooling.GetValueOnGameThread())
+	{
+		FActorSpawnParameters SpawnParams;
+		SpawnParams.Instigator = InInstigator;
+		SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+
+		return GetWorld()->SpawnActor<ARogueProjectile>(ProjectileClass, SpawnTransform, SpawnParams);
+	}
+
+	FRogueProjectilePool& Pool = Pools.FindOrAdd(ProjectileClass);
+
+	ARogueProjectile* Projectile = nullptr;
+	while (Pool.Inactive.Num() > 0 && Projectile == nullptr)
+	{
+		// Skip any that got destroyed while pooled, eg. during level streaming
+		Projectile = Pool.Inactive.Pop(EAllowShrinking::No);
+		if (!IsValid(Projectile))
+		{
+			Projectile = nullptr;
+		}
+	}
+
+	if (Projectile)
+	{
+		Pool.Hits++;
+		Projectile->SetActorLocationAndRotation(SpawnTransform.GetLocation(), SpawnTransform.GetRotation(), false,
+		                                        nullptr, ETeleportType::ResetPhysics);
+		Projectile->SetInstigator(InInstigator);
+	}
+	else
+	{
+		Pool.Misses++;
+		INC_DWORD_STAT(STAT_ProjectilePoolMisses);
+		Projectile = SpawnPooledProjectile(ProjectileClass, SpawnTransform, InInstigator);
+		if (Projectile == nullptr)
+		{
+			return nullptr;
+		}
+	}
+
+	Pool.NumActive++;
+	Pool.PeakActive = FMath::Max(Pool.PeakActive, Pool.NumActive);
+	INC_DWORD_STAT(STAT_ActivePooledProjectiles);
+
+	Projectile->bIsInPool = false;
+	Projectile->OnAcquiredFromPool();
+
+	return Projectile;
+}
+
+void URogueProjectileSubsystem::ReleaseProjectile(ARogueProjectile* Projectile)
+{
+	check(Projectile->bIsPooled);
+
+	// Multiple paths may end the same projectile in one frame, eg. a hit followed by its lifespan expiring
+	if (Projectile->bIsInPool)
+	{
+		return;
+	}
+
+	Projectile->bIsInPool = true;
+	Projectile->OnReleasedToPool();
+
+	FRogueProjectilePool& Pool = Pools.FindOrAdd(Projectile->GetClass());
+	Pool.Inactive.Add(Projectile);
+	Pool.NumActive--;
+	DEC_DWORD_STAT(STAT_ActivePooledProjectiles);
+}
+
+void URogueProjectileSubsystem::PrewarmPool(TSubclassOf<ARogueProjectile> ProjectileClass, int32 Count)
+{
+	FRogueProjectilePool& Pool = Pools.FindOrAdd(ProjectileClass);
+	Pool.Inactive.Reserve(Pool.Inactive.Num() + Count);
+
+	for (int32 i = 0; i < Count; i++)
+	{
+		ARogueProjectile* Projectile = SpawnPooledProjectile(ProjectileClass, FTransform::Identity, nullptr);
+		if (Projectile == nullptr)
+		{
+			break;
+		}
+
+		Projectile->bIsInPool = true;
+		Projectile->OnReleasedToPool();
+
+		Pool.Inactive.Add(Projectile);
+	}
+}
+
+ARogueProjectile* URogueProjectileSubsystem::SpawnPooledProjectile(TSubclassOf<ARogueProjectile> ProjectileClass,
+                                                                  const FTransform& SpawnTransform, APawn* InInstigator)
+{
+	ARogueProjectile* Projectile = GetWorld()->SpawnActorDeferred<ARogueProjectile>(ProjectileClass, SpawnTransform,
+		nullptr, InInstigator, ESpawnActorCollisionHandlingMethod::AlwaysSpawn);
+	if (Projectile == nullptr)
+	{
+		return nullptr;
+	}
+
+	// Must be known before BeginPlay, pooled projectiles are launched by SpawnProjectile instead
+	Projectile->bIsPooled = true;
+	Projectile->FinishSpawning(SpawnTransform);
+
+	return Projectile;
+}
+
+void URogueProjectileSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	VolleyRandomStream.Initialize(VolleySeed != 0 ? VolleySeed : FMath::Rand());
+}
+
+void URogueProjectileSubsystem::QueueVolleyShot(const FRogueVolleyShot& Shot)
+{
+	QueuedVolleyShots.Add(Shot);
+}
+
+void URogueProjectileSubsystem::FireQueuedVolleyShots()
+{
+	if (QueuedVolleyShots.IsEmpty())
+	{
+		return;
+	}
+
+	SCOPE_CYCLE_COUNTER(STAT_FireVolleys);
+	INC_DWORD_STAT_BY(STAT_VolleyShots, QueuedVolleyShots.Num());
+
+	// Resolve every muzzle and aim first, spawning below may run gameplay code that queues new shots
+	TArray<FRogueVolleyShot> Shots = MoveTemp(QueuedVolleyShots);
+	QueuedVolleyShots.Reset();
+
+	TArray<FTransform, TInlineAllocator<16>> SpawnTransforms;
+	SpawnTransforms.SetNum(Shots.Num());
+
+	for (int32 i = 0; i < Shots.Num(); i++)
+	{
+		ACharacter* Shooter = Shots[i].Shooter.Get();
+		AActor* TargetActor = Shots[i].TargetActor.Get();
+		if (Shooter == nullptr || TargetActor == nullptr)
+		{
+			Shots[i].ProjectileClass = nullptr;
+			continue;
+		}
+
+		FVector SpawnLocation = Shooter->GetMesh()->GetSocketLocation(Shots[i].MuzzleSocketName);
+		FRotator SpawnRotation = (TargetActor->GetActorLocation() - SpawnLocation).Rotation();
+
+		SpawnRotation.Pitch += VolleyRandomStream.FRandRange(0.0f, Shots[i].MaxSpread);
+		SpawnRotation.Yaw += VolleyRandomStream.FRandRange(-Shots[i].MaxSpread, Shots[i].MaxSpread);
+
+		SpawnTransforms[i] = FTransform(SpawnRotation, SpawnLocation);
+	}
+
+	for (int32 i = 0; i < Shots.Num(); i++)
+	{
+		if (Shots[i].ProjectileClass)
+		{
+			SpawnProjectile(Shots[i].ProjectileClass, SpawnTransforms[i], Shots[i].Shooter.Get());
+		}
+	}
+}
+
+void URogueProjectileSubsystem::OnWorldBeginPlay(UWorld& InWorld)
+{
+	Super::OnWorldBeginPlay(InWorld);
+
+	for (const FRogueProjectilePrewarm& Prewarm : PrewarmPools)
+	{
+		if (TSubclassOf<ARogueProjectile> ProjectileClass = Prewarm.ProjectileClass.LoadSynchronous())
+		{
+			PrewarmPool(ProjectileClass, Prewarm.Count);
+		}
+	}
+}
+
+void URogueProjectileSubsystem::RegisterBatchedProjectile(ARogueProjectile* Projectile, const FVector& Velocity,
+                                                          float GravityZ)
+{
+	check(Projectile->BatchedIndex == INDEX_NONE);
+
+	Projectile->BatchedIndex = BatchedProjectiles.Add(Projectile);
+	BatchedLocations.Add(Projectile->GetActorLocation());
+	BatchedVelocities.Add(Velocity);
+	BatchedGravityZ.Add(GravityZ);
+	BatchedSweepEnds.Add(FVector::ZeroVector);
+	BatchedTraceHandles.Add(FTraceHandle());
+
+	INC_DWORD_STAT(STAT_BatchedProjectiles);
+}
+
+void URogueProjectileSubsystem::UnregisterBatchedProjectile(ARogueProjectile* Projectile)
+{
+	check(BatchedProjectiles[Projectile->BatchedIndex] == Projectile);
+
+	BatchedProjectiles[Projectile->BatchedIndex] = nullptr;
+	Projectile->BatchedIndex = INDEX_NONE;
+	bHasClearedBatchedSlots = true;
+
+	DEC_DWORD_STAT(STAT_BatchedProjectiles);
+}
+
+void URogueProjectileSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	FireQueuedVolleyShots();
+
+	SCOPE_CYCLE_COUNTER(STAT_BatchedProjectileMovement);
+
+	// A volley landing on one target this frame reaches its attribute listeners as a single change
+	FRogueAttributeBatchGroup AttributeBatch;
+
+	ResolveAsyncSweeps();
+	CompactBatchedProjectiles();
+
+	if (BatchedProjectiles.IsEmpty())
+	{
+		return;
+	}
+
+	// Integrate in one tight loop over the contiguous state, the sweeps below only read the result
+	const int32 NumBatched = BatchedProjectiles.Num();
+	for (int32 i = 0; i < NumBatched; i++)
+	{
+		BatchedVelocities[i].Z += BatchedGravityZ[i] * DeltaTime;
+		BatchedSweepEnds[i] = BatchedLocations[i] + BatchedVelocities[i] * DeltaTime;
+	}
+
+	SweepBatchedProjectiles(DeltaTime);
+	CompactBatchedProjectiles();
+}
+
+void URogueProjectileSubsystem::SweepBatchedProjectiles(float DeltaTime)
+{
+	UWorld* World = GetWorld();
+	const bool bAsyncSweeps = CVarProjectileAsyncBatchedSweeps.GetValueOnGameThread();
+
+	// Projectiles may be added while iterating (eg. spawned from a hit), those start moving next frame
+	const int32 NumBatched = BatchedProjectiles.Num();
+	for (int32 i = 0; i < NumBatched; i++)
+	{
+		ARogueProjectile* Projectile = BatchedProjectiles[i];
+		if (Projectile == nullptr)
+		{
+			continue;
+		}
+
+		if (bAsyncSweeps)
+		{
+			USphereComponent* Sphere = Projectile->SphereComponent;
+
+			FCollisionQueryParams QueryParams(SCENE_QUERY_STAT(BatchedProjectileSweep), false, Projectile);
+			for (AActor* IgnoredActor : Sphere->GetMoveIgnoreActors())
+			{
+				QueryParams.AddIgnoredActor(IgnoredActor);
+			}
+
+			BatchedTraceHandles[i] = World->AsyncSweepByChannel(EAsyncTraceType::Single, BatchedLocations[i],
+			                                                    BatchedSweepEnds[i], FQuat::Identity,
+			                                                    Sphere->GetCollisionObjectType(),
+			                                                    Sphere->GetCollisionShape(), QueryParams,
+			                                                    FCollisionResponseParams(Sphere->GetCollisionResponseToChannels()));
+			continue;
+		}
+
+		// Sweeping the root dispatches OnComponentHit and overlaps exactly like the ProjectileMovementComponent does
+		FHitResult Hit;
+		Projectile->SetActorLocation(BatchedSweepEnds[i], true, &Hit);
+
+		// OnActorHit may already have released the projectile, which clears its slot
+		if (BatchedProjectiles[i] == nullptr)
+		{
+			continue;
+		}
+
+		BatchedLocations[i] = Projectile->GetActorLocation();
+
+		// Non-bouncing projectiles stop on their first blocking hit
+		if (Hit.bBlockingHit)
+		{
+			UnregisterBatchedProjectile(Projectile);
+		}
+	}
+}
+
+void URogueProjectileSubsystem::ResolveAsyncSweeps()
+{
+	UWorld* World = GetWorld();
+
+	const int32 NumBatched = BatchedProjectiles.Num();
+	for (int32 i = 0; i < NumBatched; i++)
+	{
+		FTraceHandle& TraceHandle = BatchedTraceHandles[i];
+		if (!TraceHandle.IsValid())
+		{
+			continue;
+		}
+
+		FTraceDatum TraceData;
+		bool bHasData = World->QueryTraceData(TraceHandle, TraceData);
+		TraceHandle.Invalidate();
+
+		ARogueProjectile* Projectile = BatchedProjectiles[i];
+		if (Projectile == nullptr || !bHasData)
+		{
+			continue;
+		}
+
+		const FHitResult* BlockingHit = TraceData.OutHits.FindByPredicate([](const FHitResult& Hit)
+		{
+			return Hit.bBlockingHit;
+		});
+
+		if (BlockingHit == nullptr)
+		{
+			Projectile->SetActorLocation(BatchedSweepEnds[i]);
+			BatchedLocations[i] = BatchedSweepEnds[i];
+			continue;
+		}
+
+		Projectile->SetActorLocation(BlockingHit->Location);
+		UnregisterBatchedProjectile(Projectile);
+
+		Projectile->SphereComponent->DispatchBlockingHit(*Projectile, *BlockingHit);
+	}
+}
+
+void URogueProjectileSubsystem::CompactBatchedProjectiles()
+{
+	if (!bHasClearedBatchedSlots)
+	{
+		return;
+	}
+
+	bHasClearedBatchedSlots = false;
+
+	for (int32 i = BatchedProjectiles.Num() - 1; i >= 0; i--)
+	{
+		if (BatchedProjectiles[i] != nullptr)
+		{
+			continue;
+		}
+
+		BatchedProjectiles.RemoveAtSwap(i, EAllowShrinking::No);
+		BatchedLocations.RemoveAtSwap(i, EAllowShrinking::No);
+		BatchedVelocities.RemoveAtSwap(i, EAllowShrinking::No);
+		BatchedGravityZ.RemoveAtSwap(i, EAllowShrinking::No);
+		BatchedSweepEnds.RemoveAtSwap(i, EAllowShrinking::No);
+		BatchedTraceHandles.RemoveAtSwap(i, EAllowShrinking::No);
+
+		if (BatchedProjectiles.IsValidIndex(i))
+		{
+			BatchedProjectiles[i]->BatchedIndex = i;
+		}
+	}
+}
+
+TStatId URogueProjectileSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(URogueProjectileSubsystem, STATGROUP_Tickables);
+}
+
+bool URogueProjectileSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void URogueProjectileSubsystem::LogPoolStats() const
+{
+	for (const TPair<TSubclassOf<ARogueProjectile>, FRogueProjectilePool>& Pair : Pools)
+	{
+		const FRogueProjectilePool& Pool = Pair.Value;
+		UE_LOG(LogTemp, Log, TEXT("Projectile pool %s: Active %d, Peak %d, Inactive %d, Hits %d, Misses %d"),
+		       *GetNameSafe(Pair.Key), Pool.NumActive, Pool.PeakActive, Pool.Inactive.Num(), Pool.Hits, Pool.Misses);
+	}
+}
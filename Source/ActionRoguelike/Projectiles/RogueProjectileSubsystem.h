@@ -0,0 +1,140 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "WorldCollision.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "RogueProjectileSubsystem.generated.h"
+
+class ARogueProjectile;
+class ACharacter;
+
+USTRUCT()
+struct FRogueProjectilePrewarm
+{
+	GENERATED_BODY()
+
+	UPROPERTY(Config)
+	TSoftClassPtr<ARogueProjectile> ProjectileClass;
+
+	UPROPERTY(Config)
+	int32 Count = 0;
+};
+
+USTRUCT()
+struct FRogueProjectilePool
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	TArray<TObjectPtr<ARogueProjectile>> Inactive;
+
+	int32 NumActive = 0;
+
+	int32 PeakActive = 0;
+
+	/* Acquires served from Inactive */
+	int32 Hits = 0;
+
+	/* Acquires that had to spawn a new Actor */
+	int32 Misses = 0;
+};
+
+/* Ranged attack waiting for the next volley, resolved by the subsystem at the end of the frame */
+struct FRogueVolleyShot
+{
+	TWeakObjectPtr<ACharacter> Shooter;
+
+	TWeakObjectPtr<AActor> TargetActor;
+
+	TSubclassOf<ARogueProjectile> ProjectileClass;
+
+	FName MuzzleSocketName;
+
+	/* Degrees of random pitch (upwards only) and yaw added to the aim */
+	float MaxSpread = 0.0f;
+};
+
+/* Recycles projectile Actors per class instead of spawning and destroying one for every shot,
+ * and moves projectiles that opt into bUseBatchedMovement in a single pass per frame */
+UCLASS(Config=Game)
+class ACTIONROGUELIKE_API URogueProjectileSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	/* Replaces SpawnActor for projectiles, the result is launched from SpawnTransform with InInstigator */
+	ARogueProjectile* SpawnProjectile(TSubclassOf<ARogueProjectile> ProjectileClass, const FTransform& SpawnTransform,
+	                                  APawn* InInstigator);
+
+	void ReleaseProjectile(ARogueProjectile* Projectile);
+
+	void PrewarmPool(TSubclassOf<ARogueProjectile> ProjectileClass, int32 Count);
+
+	void LogPoolStats() const;
+
+	/* Buffers a shot from the muzzle of Shooter towards TargetActor, all shots of a frame are fired together during Tick */
+	void QueueVolleyShot(const FRogueVolleyShot& Shot);
+
+	void RegisterBatchedProjectile(ARogueProjectile* Projectile, const FVector& Velocity, float GravityZ);
+
+	void UnregisterBatchedProjectile(ARogueProjectile* Projectile);
+
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+
+	virtual void OnWorldBeginPlay(UWorld& InWorld) override;
+
+	virtual void Tick(float DeltaTime) override;
+
+	virtual TStatId GetStatId() const override;
+
+protected:
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+	ARogueProjectile* SpawnPooledProjectile(TSubclassOf<ARogueProjectile> ProjectileClass, const FTransform& SpawnTransform,
+	                                        APawn* InInstigator);
+
+	/* Spawned into the pool on world begin play, set up in DefaultGame.ini */
+	UPROPERTY(Config)
+	TArray<FRogueProjectilePrewarm> PrewarmPools;
+
+	UPROPERTY()
+	TMap<TSubclassOf<ARogueProjectile>, FRogueProjectilePool> Pools;
+
+	void FireQueuedVolleyShots();
+
+	TArray<FRogueVolleyShot> QueuedVolleyShots;
+
+	/* Seed for volley spread, 0 picks a new seed every session */
+	UPROPERTY(Config)
+	int32 VolleySeed = 0;
+
+	FRandomStream VolleyRandomStream;
+
+	/* Sweeps every batched projectile from its current to its next location, hits are dispatched as regular component hits */
+	void SweepBatchedProjectiles(float DeltaTime);
+
+	/* Applies the sweeps issued last frame, in async mode the projectiles trail their simulation by one frame */
+	void ResolveAsyncSweeps();
+
+	void CompactBatchedProjectiles();
+
+	/* Lightweight projectile state, parallel arrays indexed by ARogueProjectile::BatchedIndex.
+	 * Unregistering clears the slot, the arrays are compacted once per Tick so slots stay stable while iterating */
+	UPROPERTY()
+	TArray<TObjectPtr<ARogueProjectile>> BatchedProjectiles;
+
+	TArray<FVector> BatchedLocations;
+
+	TArray<FVector> BatchedVelocities;
+
+	TArray<float> BatchedGravityZ;
+
+	/* Sweep end of the pending async trace per slot */
+	TArray<FVector> BatchedSweepEnds;
+
+	TArray<FTraceHandle> BatchedTraceHandles;
+
+	bool bHasClearedBatchedSlots = false;
+};
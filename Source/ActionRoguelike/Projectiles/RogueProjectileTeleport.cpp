@@ -12,9 +12,9 @@ ARogueProjectileTeleport::ARogueProjectileTeleport()
 	ProjectileMovementComponent->InitialSpeed = 6000.0f;
 }
 
-void ARogueProjectileTeleport::BeginPlay()
+void ARogueProjectileTeleport::OnLaunched()
 {
-	Super::BeginPlay();
+	Super::OnLaunched();
 
 	GetWorldTimerManager().SetTimer(TeleportHandle, this, &ThisClass::StartDelayedTeleport, DetonateDelay);
 	GetInstigator()->MoveIgnoreActorAdd(this);
@@ -37,7 +37,7 @@ void ARogueProjectileTeleport::StartDelayedTeleport()
 {
 	PlayExplodeEffects();
 	
-	ProjectileMovementComponent->StopMovementImmediately();
+	StopProjectileMovement();
 	// Hide all visuals and prevent any further collision while we wait on the teleport timer
 	LoopedNiagaraComponent->Deactivate();
 	LoopedAudioComponent->Stop();
@@ -58,5 +58,5 @@ void ARogueProjectileTeleport::HandleTeleportation()
 	// note: the teleport call might fail if it cannot find any valid location
 
 	// Clear projectile from world, can't do this any sooner as that would prevent the timers from running on a valid Actor
-	Destroy();
+	FinishProjectile();
 }
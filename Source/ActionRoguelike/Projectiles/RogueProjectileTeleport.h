@@ -25,7 +25,7 @@ protected:
 
 	void HandleTeleportation();
 
-	virtual void BeginPlay() override;
+	virtual void OnLaunched() override;
 
 	virtual void OnActorHit(UPrimitiveComponent* HitComponent, AActor* OtherActor, UPrimitiveComponent* OtherComp,
 		FVector NormalImpulse, const FHitResult& Hit) override;
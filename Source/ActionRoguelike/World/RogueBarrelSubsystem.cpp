@@ -0,0 +1,288 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "RogueBarrelSubsystem.h"
+
+#include "ActionRoguelike.h"
+#include "RogueExplosiveBarrel.h"
+#include "Components/DestructibleInterface.h"
+#include "Core/RogueEffectSubsystem.h"
+#include "GameFramework/MovementComponent.h"
+#include "PhysicsEngine/RadialForceComponent.h"
+
+DECLARE_CYCLE_STAT(TEXT("Resolve Barrel Blasts"), STAT_ResolveBarrelBlasts, STATGROUP_ActionRoguelike);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Barrel Blasts"), STAT_BarrelBlasts, STATGROUP_ActionRoguelike);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Barrel Blast Queries"), STAT_BarrelBlastQueries, STATGROUP_ActionRoguelike);
+
+
+namespace
+{
+	bool FuseHeapPredicate(const FRogueBarrelFuse& A, const FRogueBarrelFuse& B)
+	{
+		return A.ExplodeTime < B.ExplodeTime;
+	}
+}
+
+void URogueBarrelSubsystem::IgniteBarrel(ARogueExplosiveBarrel* InBarrel, float InDelay)
+{
+	Fuses.HeapPush({InBarrel, GetWorld()->GetTimeSeconds() + InDelay}, FuseHeapPredicate);
+}
+
+void URogueBarrelSubsystem::QueueBlast(const URadialForceComponent* InForceComponent)
+{
+	FRogueBarrelBlast& Blast = QueuedBlasts.AddDefaulted_GetRef();
+	Blast.Origin = InForceComponent->GetComponentLocation();
+	Blast.Radius = InForceComponent->Radius;
+	Blast.ImpulseStrength = InForceComponent->ImpulseStrength;
+	Blast.DestructibleDamage = InForceComponent->DestructibleDamage;
+	Blast.Falloff = InForceComponent->Falloff;
+	Blast.bImpulseVelChange = InForceComponent->bImpulseVelChange;
+	if (InForceComponent->bIgnoreOwningActor)
+	{
+		Blast.IgnoredActor = InForceComponent->GetOwner();
+	}
+
+	INC_DWORD_STAT(STAT_BarrelBlasts);
+}
+
+void URogueBarrelSubsystem::QueueExplosionEffects(UNiagaraSystem* InEffect, USoundBase* InSound,
+                                                  const FVector& InLocation, const FRotator& InRotation)
+{
+	QueuedEffects.Add({InEffect, InSound, InLocation, InRotation});
+}
+
+void URogueBarrelSubsystem::Tick(float DeltaTime)
+{
+	DetonateDueFuses();
+
+	if (QueuedBlasts.Num() > 0)
+	{
+		ResolveQueuedBlasts();
+	}
+
+	if (QueuedEffects.Num() > 0)
+	{
+		DispatchExplosionEffects();
+	}
+}
+
+void URogueBarrelSubsystem::DetonateDueFuses()
+{
+	double GameTime = GetWorld()->GetTimeSeconds();
+
+	while (Fuses.Num() > 0 && Fuses.HeapTop().ExplodeTime <= GameTime)
+	{
+		FRogueBarrelFuse Fuse;
+		Fuses.HeapPop(Fuse, FuseHeapPredicate, EAllowShrinking::No);
+
+		if (ARogueExplosiveBarrel* Barrel = Fuse.Barrel.Get())
+		{
+			Barrel->Explode();
+		}
+	}
+}
+
+void URogueBarrelSubsystem::ResolveQueuedBlasts()
+{
+	SCOPE_CYCLE_COUNTER(STAT_ResolveBarrelBlasts);
+
+	const int32 NumBlasts = QueuedBlasts.Num();
+
+	float MaxRadius = 0.0f;
+	for (const FRogueBarrelBlast& Blast : QueuedBlasts)
+	{
+		MaxRadius = FMath::Max(MaxRadius, Blast.Radius);
+	}
+
+	// Any two overlapping spheres are at most one cell apart on every axis
+	double CellSize = FMath::Max(2.0 * MaxRadius, 1.0);
+
+	TArray<int32, TInlineAllocator<16>> Parents;
+	Parents.SetNumUninitialized(NumBlasts);
+	for (int32 i = 0; i < NumBlasts; i++)
+	{
+		Parents[i] = i;
+	}
+
+	auto FindRoot = [&Parents](int32 Index)
+	{
+		while (Parents[Index] != Index)
+		{
+			Parents[Index] = Parents[Parents[Index]];
+			Index = Parents[Index];
+		}
+		return Index;
+	};
+
+	// Link every pair of overlapping blasts, connected groups then share one query
+	TMap<FIntVector, TArray<int32, TInlineAllocator<4>>> Cells;
+	for (int32 i = 0; i < NumBlasts; i++)
+	{
+		const FRogueBarrelBlast& Blast = QueuedBlasts[i];
+		FIntVector Cell(FMath::FloorToInt32(Blast.Origin.X / CellSize),
+		                FMath::FloorToInt32(Blast.Origin.Y / CellSize),
+		                FMath::FloorToInt32(Blast.Origin.Z / CellSize));
+
+		for (int32 X = -1; X <= 1; X++)
+		{
+			for (int32 Y = -1; Y <= 1; Y++)
+			{
+				for (int32 Z = -1; Z <= 1; Z++)
+				{
+					const auto* Neighbours = Cells.Find(Cell + FIntVector(X, Y, Z));
+					if (Neighbours == nullptr)
+					{
+						continue;
+					}
+
+					for (int32 j : *Neighbours)
+					{
+						const FRogueBarrelBlast& Other = QueuedBlasts[j];
+						if (FVector::DistSquared(Blast.Origin, Other.Origin) <= FMath::Square(Blast.Radius + Other.Radius))
+						{
+							Parents[FindRoot(i)] = FindRoot(j);
+						}
+					}
+				}
+			}
+		}
+
+		Cells.FindOrAdd(Cell).Add(i);
+	}
+
+	TMap<int32, TArray<int32, TInlineAllocator<8>>> Groups;
+	for (int32 i = 0; i < NumBlasts; i++)
+	{
+		Groups.FindOrAdd(FindRoot(i)).Add(i);
+	}
+
+	// Same object types and params URadialForceComponent uses by default, the barrel doesn't change them
+	FCollisionObjectQueryParams ObjectParams;
+	ObjectParams.AddObjectTypesToQuery(ECC_Pawn);
+	ObjectParams.AddObjectTypesToQuery(ECC_PhysicsBody);
+	ObjectParams.AddObjectTypesToQuery(ECC_Vehicle);
+	ObjectParams.AddObjectTypesToQuery(ECC_Destructible);
+
+	static FName BarrelBlastOverlapName = FName(TEXT("BarrelBlastOverlap"));
+	FCollisionQueryParams Params(BarrelBlastOverlapName, false);
+
+	UWorld* World = GetWorld();
+	TArray<FOverlapResult> Overlaps;
+	TArray<UPrimitiveComponent*> Components;
+
+	for (const auto& Group : Groups)
+	{
+		// Bounding sphere around all the blasts in the group
+		FBox GroupBounds(ForceInit);
+		for (int32 BlastIndex : Group.Value)
+		{
+			const FRogueBarrelBlast& Blast = QueuedBlasts[BlastIndex];
+			GroupBounds += FBox::BuildAABB(Blast.Origin, FVector(Blast.Radius));
+		}
+
+		FVector QueryCenter = GroupBounds.GetCenter();
+		double QueryRadius = 0.0;
+		for (int32 BlastIndex : Group.Value)
+		{
+			const FRogueBarrelBlast& Blast = QueuedBlasts[BlastIndex];
+			QueryRadius = FMath::Max(QueryRadius, FVector::Dist(QueryCenter, Blast.Origin) + Blast.Radius);
+		}
+
+		Overlaps.Reset();
+		World->OverlapMultiByObjectType(Overlaps, QueryCenter, FQuat::Identity, ObjectParams,
+		                                FCollisionShape::MakeSphere(QueryRadius), Params);
+		INC_DWORD_STAT(STAT_BarrelBlastQueries);
+
+		Components.Reset();
+		for (const FOverlapResult& Overlap : Overlaps)
+		{
+			if (UPrimitiveComponent* Component = Overlap.Component.Get())
+			{
+				Components.AddUnique(Component);
+			}
+		}
+
+		for (int32 BlastIndex : Group.Value)
+		{
+			ApplyBlast(QueuedBlasts[BlastIndex], Components);
+		}
+	}
+
+	QueuedBlasts.Reset();
+}
+
+void URogueBarrelSubsystem::ApplyBlast(const FRogueBarrelBlast& Blast,
+                                       TConstArrayView<UPrimitiveComponent*> Components) const
+{
+	FCollisionShape BlastShape = FCollisionShape::MakeSphere(Blast.Radius);
+	AActor* IgnoredActor = Blast.IgnoredActor.Get();
+
+	for (UPrimitiveComponent* Component : Components)
+	{
+		if (IgnoredActor && Component->GetOwner() == IgnoredActor)
+		{
+			continue;
+		}
+
+		// Narrow the shared query down to the components this blast alone would have overlapped
+		if (!FMath::SphereAABBIntersection(Blast.Origin, FMath::Square(Blast.Radius), Component->Bounds.GetBox())
+			|| !Component->OverlapComponent(Blast.Origin, FQuat::Identity, BlastShape))
+		{
+			continue;
+		}
+
+		// Mirrors URadialForceComponent::FireImpulse() for each affected component
+		if (Blast.DestructibleDamage > UE_SMALL_NUMBER)
+		{
+			if (IDestructibleInterface* Destructible = Cast<IDestructibleInterface>(Component))
+			{
+				Destructible->ApplyRadiusDamage(Blast.DestructibleDamage, Blast.Origin, Blast.Radius,
+				                                Blast.ImpulseStrength, Blast.Falloff == RIF_Constant);
+			}
+		}
+
+		Component->AddRadialImpulse(Blast.Origin, Blast.Radius, Blast.ImpulseStrength, Blast.Falloff,
+		                            Blast.bImpulseVelChange);
+
+		if (!Component->bIgnoreRadialImpulse && Component->GetOwner())
+		{
+			TInlineComponentArray<UMovementComponent*> MovementComponents;
+			Component->GetOwner()->GetComponents(MovementComponents);
+			for (UMovementComponent* MovementComponent : MovementComponents)
+			{
+				if (MovementComponent->UpdatedComponent == Component)
+				{
+					MovementComponent->AddRadialImpulse(Blast.Origin, Blast.Radius, Blast.ImpulseStrength,
+					                                    Blast.Falloff, Blast.bImpulseVelChange);
+					break;
+				}
+			}
+		}
+	}
+}
+
+void URogueBarrelSubsystem::DispatchExplosionEffects()
+{
+	URogueEffectSubsystem* EffectSubsystem = GetWorld()->GetSubsystem<URogueEffectSubsystem>();
+
+	int32 NumToDispatch = FMath::Min(QueuedEffects.Num(), MaxExplosionEffectsPerFrame);
+	for (int32 i = 0; i < NumToDispatch; i++)
+	{
+		const FRogueBarrelExplosionEffects& Effects = QueuedEffects[i];
+		EffectSubsystem->PlayEffectAtLocation(Effects.Effect, Effects.Location, Effects.Rotation);
+		EffectSubsystem->PlaySoundAtLocation(Effects.Sound, Effects.Location);
+	}
+
+	// Remaining effects go out over the next frames in the order the barrels exploded
+	QueuedEffects.RemoveAt(0, NumToDispatch, EAllowShrinking::No);
+}
+
+TStatId URogueBarrelSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(URogueBarrelSubsystem, STATGROUP_Tickables);
+}
+
+bool URogueBarrelSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
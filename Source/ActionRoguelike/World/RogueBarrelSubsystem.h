@@ -0,0 +1,99 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/EngineTypes.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "RogueBarrelSubsystem.generated.h"
+
+class ARogueExplosiveBarrel;
+class UNiagaraSystem;
+class URadialForceComponent;
+class USoundBase;
+
+struct FRogueBarrelFuse
+{
+	TWeakObjectPtr<ARogueExplosiveBarrel> Barrel;
+
+	double ExplodeTime = 0.0;
+};
+
+/* Snapshot of a radial force component at the moment it fired, applied at the end of the frame */
+struct FRogueBarrelBlast
+{
+	FVector Origin = FVector::ZeroVector;
+
+	float Radius = 0.0f;
+
+	float ImpulseStrength = 0.0f;
+
+	float DestructibleDamage = 0.0f;
+
+	TEnumAsByte<ERadialImpulseFalloff> Falloff = RIF_Constant;
+
+	bool bImpulseVelChange = false;
+
+	TWeakObjectPtr<AActor> IgnoredActor;
+};
+
+USTRUCT()
+struct FRogueBarrelExplosionEffects
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	TObjectPtr<UNiagaraSystem> Effect;
+
+	UPROPERTY()
+	TObjectPtr<USoundBase> Sound;
+
+	FVector Location = FVector::ZeroVector;
+
+	FRotator Rotation = FRotator::ZeroRotator;
+};
+
+/* Runs the fuses of all explosive barrels and resolves their blasts together. Blasts in the same frame with overlapping
+ * spheres are grouped through a coarse grid and share a single overlap query, each blast then applies the same impulses
+ * FireImpulse would have. Explosion effects are released a few per frame so a chain reaction doesn't spike in one frame */
+UCLASS(Config=Game)
+class ACTIONROGUELIKE_API URogueBarrelSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	void IgniteBarrel(ARogueExplosiveBarrel* InBarrel, float InDelay);
+
+	/* Replaces URadialForceComponent::FireImpulse(), the impulse is applied before the next physics step */
+	void QueueBlast(const URadialForceComponent* InForceComponent);
+
+	void QueueExplosionEffects(UNiagaraSystem* InEffect, USoundBase* InSound, const FVector& InLocation,
+	                           const FRotator& InRotation);
+
+	virtual void Tick(float DeltaTime) override;
+
+	virtual TStatId GetStatId() const override;
+
+protected:
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+	void DetonateDueFuses();
+
+	void ResolveQueuedBlasts();
+
+	void ApplyBlast(const FRogueBarrelBlast& Blast, TConstArrayView<UPrimitiveComponent*> Components) const;
+
+	void DispatchExplosionEffects();
+
+	UPROPERTY(Config)
+	int32 MaxExplosionEffectsPerFrame = 4;
+
+	/* Min-heap on ExplodeTime */
+	TArray<FRogueBarrelFuse> Fuses;
+
+	TArray<FRogueBarrelBlast> QueuedBlasts;
+
+	/* Can wait several frames for its turn, referenced so the assets stay loaded meanwhile */
+	UPROPERTY()
+	TArray<FRogueBarrelExplosionEffects> QueuedEffects;
+};
@@ -3,9 +3,10 @@
 
 #include "RogueExplosiveBarrel.h"
 
+#include "RogueBarrelSubsystem.h"
 #include "NiagaraComponent.h"
 #include "Components/AudioComponent.h"
-#include "NiagaraFunctionLibrary.h"
+#include "Core/RogueEffectSubsystem.h"
 #include "Kismet/GameplayStatics.h"
 #include "PhysicsEngine/RadialForceComponent.h"
 
@@ -34,43 +35,59 @@ float ARogueExplosiveBarrel::TakeDamage(float DamageAmount, struct FDamageEvent
 {
 	float ActualDamage = Super::TakeDamage(DamageAmount, DamageEvent, EventInstigator, DamageCauser);
 
-	// Allow exploding once, also skip when timer is already running
-	if (bExploded || GetWorldTimerManager().TimerExists(ExplosionTimerHandle))
+	// Allow exploding once, also skip when the fuse is already running
+	if (bExploded || bIgnited)
 	{
 		return ActualDamage;
 	}
 
 	// Hold onto both the Niagara and Audio Components to disable them during the Explode()
 	
-	ActiveBurningEffectComp = UNiagaraFunctionLibrary::SpawnSystemAttached(BurningEffect, MeshComponent, NAME_None,
-		FVector::ZeroVector, FRotator::ZeroRotator, EAttachLocation::Type::SnapToTarget, true);
+	URogueEffectSubsystem* EffectSubsystem = GetWorld()->GetSubsystem<URogueEffectSubsystem>();
+	ActiveBurningEffectComp = EffectSubsystem->SpawnEffectAttached(BurningEffect, MeshComponent, NAME_None, true);
 
 	ActiveBurningSoundComp = UGameplayStatics::SpawnSoundAttached(BurningSound, MeshComponent);
 	
-	GetWorldTimerManager().SetTimer(ExplosionTimerHandle, this, &ARogueExplosiveBarrel::Explode, ExplosionDelay);
+	bIgnited = true;
+	GetWorld()->GetSubsystem<URogueBarrelSubsystem>()->IgniteBarrel(this, ExplosionDelay);
 
 	return ActualDamage;
 }
 
-void ARogueExplosiveBarrel::Explode()
+void ARogueExplosiveBarrel::StopBurningEffects()
 {
-	bExploded = true;
-
 	if (ActiveBurningEffectComp)
 	{
-		ActiveBurningEffectComp->Deactivate();
+		// Deactivates and returns to the pool once the remaining particles have finished
+		ActiveBurningEffectComp->ReleaseToPool();
+		ActiveBurningEffectComp = nullptr;
 	}
 	if (ActiveBurningSoundComp)
 	{
 		ActiveBurningSoundComp->Stop();
+		ActiveBurningSoundComp = nullptr;
 	}
+}
+
+void ARogueExplosiveBarrel::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	StopBurningEffects();
+
+	Super::EndPlay(EndPlayReason);
+}
 
-	RadialForceComponent->FireImpulse();
+void ARogueExplosiveBarrel::Explode()
+{
+	bExploded = true;
+
+	StopBurningEffects();
+
+	// Resolved together with any other barrel exploding this frame instead of RadialForceComponent->FireImpulse()
+	URogueBarrelSubsystem* BarrelSubsystem = GetWorld()->GetSubsystem<URogueBarrelSubsystem>();
+	BarrelSubsystem->QueueBlast(RadialForceComponent);
 
 	MeshComponent->AddImpulse(FVector::UpVector * 100, NAME_None, true);
 	MeshComponent->AddAngularImpulseInDegrees(FVector::RightVector * 100, NAME_None, true);
-	
-	UNiagaraFunctionLibrary::SpawnSystemAtLocation(this, ExplosionEffect, GetActorLocation(), GetActorRotation());
 
-	UGameplayStatics::PlaySoundAtLocation(this, ExplosionSound, GetActorLocation(), FRotator::ZeroRotator);
+	BarrelSubsystem->QueueExplosionEffects(ExplosionEffect, ExplosionSound, GetActorLocation(), GetActorRotation());
 }
@@ -45,13 +45,21 @@ protected:
 
 	bool bExploded = false;
 
-	FTimerHandle ExplosionTimerHandle;
+	/* Fuse is running on the barrel subsystem */
+	bool bIgnited = false;
 	
 	UPROPERTY()
 	TObjectPtr<UNiagaraComponent> ActiveBurningEffectComp = nullptr;
 	
 	UPROPERTY()
 	TObjectPtr<UAudioComponent> ActiveBurningSoundComp = nullptr;
+
+	friend class URogueBarrelSubsystem;
+
+	/* Burning effects are pooled, a barrel destroyed before its fuse fires has to hand them back itself */
+	void StopBurningEffects();
+
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
 	
 public:
 
@@ -6,8 +6,8 @@
 #include "SharedGameplayTags.h"
 #include "ActionSystem/RogueActionSystemComponent.h"
 #include "Components/SphereComponent.h"
+#include "Core/RogueEffectSubsystem.h"
 #include "Core/RogueGameplayStatics.h"
-#include "Kismet/GameplayStatics.h"
 
 ARoguePickupHealthPotion::ARoguePickupHealthPotion() : ARoguePickup()
 {
@@ -30,7 +30,7 @@ void ARoguePickupHealthPotion::OnSphereOverlappedActor(UPrimitiveComponent* Over
 	if (ensure(ActionComp != nullptr) && !URogueGameplayStatics::IsFullHealth(ActionComp))
 	{
 		ActionComp->ApplyAttributeChange(SharedGameplayTags::Attribute_Health, HealingAmount, Base);
-		UGameplayStatics::PlaySoundAtLocation(this, PickupSound, GetActorLocation(), FRotator::ZeroRotator);
+		GetWorld()->GetSubsystem<URogueEffectSubsystem>()->PlaySoundAtLocation(PickupSound, GetActorLocation());
 		Destroy();
 	}
 }